@@ -0,0 +1,201 @@
+#include "checkpointstore.h"
+#include "macros.h"
+#include "oslutils.h"
+
+#include <boost/functional/hash.hpp>
+
+#include <cstring>
+#include <iterator>
+
+const size_t CheckpointStore::DEFAULT_INTERVAL;
+const size_t CheckpointStore::DEFAULT_BUDGET;
+
+static size_t scopBytes(osl_scop_p scop) {
+  size_t bytes = sizeof(*scop) + oslRelationBytes(scop->context);
+  oslListForeach(scop->statement, [&bytes](osl_statement_p stmt) {
+    bytes += sizeof(*stmt) + oslRelationBytes(stmt->domain) + oslRelationBytes(stmt->scattering);
+    for (osl_relation_list_p access = stmt->access; access != nullptr; access = access->next) {
+      bytes += sizeof(*access) + oslRelationBytes(access->elt);
+    }
+  });
+  return bytes;
+}
+
+// Hashes of all prefixes of the sequence, element i corresponds to the first i groups.
+static std::vector<size_t> prefixHashes(osl_scop_p original, const TransformationSequence &sequence,
+                                        size_t nbGroups) {
+  std::vector<size_t> hashes;
+  hashes.reserve(nbGroups + 1);
+  size_t seed = 0;
+  boost::hash_combine(seed, original);
+  hashes.push_back(seed);
+  for (size_t i = 0; i < nbGroups; ++i) {
+    boost::hash_combine(seed, sequence.groups[i]);
+    hashes.push_back(seed);
+  }
+  return std::move(hashes);
+}
+
+CheckpointStore::CheckpointStore(size_t interval, size_t budget) :
+  m_interval(interval), m_budget(budget) {
+  CLINT_ASSERT(interval != 0, "Checkpoint interval must be positive");
+}
+
+CheckpointStore::~CheckpointStore() {
+  clear();
+}
+
+size_t CheckpointStore::prefixHash(osl_scop_p original, const TransformationSequence &sequence, size_t nbGroups) {
+  return prefixHashes(original, sequence, nbGroups).back();
+}
+
+CheckpointStore::CheckpointList::iterator
+CheckpointStore::lookup(size_t hash, osl_scop_p original, const TransformationSequence &sequence, size_t nbGroups) {
+  auto range = m_index.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    CheckpointList::iterator checkpoint = it->second;
+    if (checkpoint->original == original &&
+        checkpoint->groups.size() == nbGroups &&
+        std::equal(std::begin(checkpoint->groups), std::end(checkpoint->groups),
+                   std::begin(sequence.groups))) {
+      return checkpoint;
+    }
+  }
+  return m_checkpoints.end();
+}
+
+const CheckpointStore::Checkpoint *
+CheckpointStore::find(osl_scop_p original, const TransformationSequence &sequence, size_t nbGroups) {
+  CLINT_ASSERT(nbGroups <= sequence.groups.size(), "Checkpoint prefix is longer than the sequence");
+  CheckpointList::iterator checkpoint =
+      lookup(prefixHash(original, sequence, nbGroups), original, sequence, nbGroups);
+  return checkpoint != m_checkpoints.end() ? &*checkpoint : nullptr;
+}
+
+const CheckpointStore::Checkpoint *
+CheckpointStore::nearest(osl_scop_p original, const TransformationSequence &sequence) {
+  std::vector<size_t> hashes = prefixHashes(original, sequence, sequence.groups.size());
+  for (size_t nbGroups = hashes.size(); nbGroups-- > 0; ) {
+    if (m_index.count(hashes[nbGroups]) == 0)
+      continue;
+    CheckpointList::iterator checkpoint = lookup(hashes[nbGroups], original, sequence, nbGroups);
+    if (checkpoint != m_checkpoints.end() && checkpoint->scop != nullptr)
+      return &*checkpoint;
+  }
+  return nullptr;
+}
+
+// Make room for @p bytes more, fails if they do not fit the budget at all.
+bool CheckpointStore::reserve(size_t bytes) {
+  if (bytes > m_budget)
+    return false;
+  evict(m_budget - bytes);
+  return true;
+}
+
+// Make room for @p bytes more in an existing entry, which becomes the newest one and thus is not evicted.
+bool CheckpointStore::extend(CheckpointList::iterator checkpoint, size_t bytes) {
+  if (checkpoint->bytes + bytes > m_budget)
+    return false;
+  m_checkpoints.splice(m_checkpoints.end(), m_checkpoints, checkpoint);
+  evict(m_budget - bytes);
+  return true;
+}
+
+CheckpointStore::CheckpointList::iterator
+CheckpointStore::insert(size_t hash, osl_scop_p original, const TransformationSequence &sequence, size_t nbGroups) {
+  Checkpoint checkpoint;
+  checkpoint.hash     = hash;
+  checkpoint.original = original;
+  checkpoint.groups   = std::vector<TransformationGroup>(std::begin(sequence.groups),
+                                                         std::begin(sequence.groups) + nbGroups);
+  checkpoint.scop     = nullptr;
+  checkpoint.hasCode  = false;
+  checkpoint.bytes    = sizeof(Checkpoint);
+  m_checkpoints.push_back(std::move(checkpoint));
+  m_index.emplace(hash, std::prev(m_checkpoints.end()));
+  m_size += sizeof(Checkpoint);
+  return std::prev(m_checkpoints.end());
+}
+
+void CheckpointStore::store(osl_scop_p original, const TransformationSequence &sequence, size_t nbGroups,
+                            osl_scop_p transformed, const DependenceAnalyzer::DependenceMap &dependences) {
+  CLINT_ASSERT(nbGroups <= sequence.groups.size(), "Checkpoint prefix is longer than the sequence");
+  size_t hash = prefixHash(original, sequence, nbGroups);
+  CheckpointList::iterator checkpoint = lookup(hash, original, sequence, nbGroups);
+  if (checkpoint != m_checkpoints.end() && checkpoint->scop != nullptr)
+    return;
+
+  size_t bytes = scopBytes(transformed);
+  if (checkpoint == m_checkpoints.end()) {
+    if (!reserve(bytes + sizeof(Checkpoint)))
+      return;
+    checkpoint = insert(hash, original, sequence, nbGroups);
+  } else if (!extend(checkpoint, bytes)) {
+    return;
+  }
+  checkpoint->scop        = osl_scop_clone(transformed);
+  checkpoint->dependences = dependences;
+  checkpoint->bytes      += bytes;
+  m_size += bytes;
+}
+
+void CheckpointStore::storeCode(osl_scop_p original, const TransformationSequence &sequence, size_t nbGroups,
+                                const char *generatedCode, const std::string &generatedHtml) {
+  CLINT_ASSERT(nbGroups <= sequence.groups.size(), "Checkpoint prefix is longer than the sequence");
+  size_t hash = prefixHash(original, sequence, nbGroups);
+  CheckpointList::iterator checkpoint = lookup(hash, original, sequence, nbGroups);
+  if (checkpoint != m_checkpoints.end() && checkpoint->hasCode)
+    return;
+
+  size_t bytes = strlen(generatedCode) + generatedHtml.size();
+  if (checkpoint == m_checkpoints.end()) {
+    if (!reserve(bytes + sizeof(Checkpoint)))
+      return;
+    checkpoint = insert(hash, original, sequence, nbGroups);
+  } else if (!extend(checkpoint, bytes)) {
+    return;
+  }
+  checkpoint->hasCode       = true;
+  checkpoint->generatedCode = generatedCode;
+  checkpoint->generatedHtml = generatedHtml;
+  checkpoint->bytes        += bytes;
+  m_size += bytes;
+}
+
+void CheckpointStore::erase(CheckpointList::iterator checkpoint) {
+  auto range = m_index.equal_range(checkpoint->hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == checkpoint) {
+      m_index.erase(it);
+      break;
+    }
+  }
+  m_size -= checkpoint->bytes;
+  if (checkpoint->scop != nullptr)
+    osl_scop_free(checkpoint->scop);
+  m_checkpoints.erase(checkpoint);
+}
+
+void CheckpointStore::evict(size_t budget) {
+  while (m_size > budget && !m_checkpoints.empty()) {
+    erase(m_checkpoints.begin());
+  }
+}
+
+void CheckpointStore::setBudget(size_t budget) {
+  m_budget = budget;
+  evict(m_budget);
+}
+
+void CheckpointStore::remove(osl_scop_p original) {
+  for (CheckpointList::iterator it = m_checkpoints.begin(); it != m_checkpoints.end(); ) {
+    CheckpointList::iterator checkpoint = it++;
+    if (checkpoint->original == original)
+      erase(checkpoint);
+  }
+}
+
+void CheckpointStore::clear() {
+  evict(0);
+}
@@ -0,0 +1,112 @@
+#ifndef CHECKPOINTSTORE_H
+#define CHECKPOINTSTORE_H
+
+#include <osl/osl.h>
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "dependenceanalyzer.h"
+#include "transformation.h"
+
+/**
+ * @brief Snapshots of transformed scops taken along the transformation sequence.
+ *
+ * A checkpoint is the result of applying a prefix of the sequence to the original scop
+ * together with its dependences.  Restoring the exact prefix avoids Clay and Candl altogether;
+ * otherwise the nearest shorter prefix is cloned and only the remaining groups are replayed.
+ * Snapshots are taken every interval() groups.  Generated code is stored for every executed
+ * prefix, with or without a snapshot, so that undo and redo never run CLooG again.  All entries
+ * are kept within a memory budget, the oldest ones evicted first.  Evicting a snapshot frees its
+ * scop but not its dependences, which the ClintDependence objects of a restored scop refer to.
+ *
+ * The store belongs to ClintProgram, so it outlives the ClintScop objects that are rebuilt on
+ * undo, redo or parameter change.
+ */
+class CheckpointStore {
+public:
+  struct Checkpoint {
+    size_t hash;
+    osl_scop_p original;
+    std::vector<TransformationGroup> groups;
+    osl_scop_p scop;                                 ///< Null if only the code is stored.
+    DependenceAnalyzer::DependenceMap dependences;
+    bool hasCode;
+    std::string generatedCode;
+    std::string generatedHtml;
+    size_t bytes;
+  };
+
+  explicit CheckpointStore(size_t interval = DEFAULT_INTERVAL, size_t budget = DEFAULT_BUDGET);
+  ~CheckpointStore();
+
+  /// Whether the result of executing the first @p nbGroups groups should be stored.
+  bool isCheckpoint(size_t nbGroups) const {
+    return nbGroups % m_interval == 0;
+  }
+
+  /// Entry for exactly the first @p nbGroups groups of @p sequence, or nullptr.  It may lack the scop or the code.
+  const Checkpoint *find(osl_scop_p original, const TransformationSequence &sequence, size_t nbGroups);
+
+  /// Entry with a scop for the longest stored prefix of @p sequence, or nullptr.
+  const Checkpoint *nearest(osl_scop_p original, const TransformationSequence &sequence);
+
+  /// Store a copy of @p transformed obtained by applying the first @p nbGroups groups of @p sequence to @p original.
+  void store(osl_scop_p original, const TransformationSequence &sequence, size_t nbGroups,
+             osl_scop_p transformed, const DependenceAnalyzer::DependenceMap &dependences);
+
+  /// Store the code generated for the first @p nbGroups groups of @p sequence.
+  void storeCode(osl_scop_p original, const TransformationSequence &sequence, size_t nbGroups,
+                 const char *generatedCode, const std::string &generatedHtml);
+
+  /// Drop all checkpoints taken for @p original.
+  void remove(osl_scop_p original);
+  void clear();
+
+  size_t interval() const {
+    return m_interval;
+  }
+
+  void setInterval(size_t interval) {
+    CLINT_ASSERT(interval != 0, "Checkpoint interval must be positive");
+    m_interval = interval;
+  }
+
+  /// Number of bytes currently used by the stored scops and code.
+  size_t size() const {
+    return m_size;
+  }
+
+  size_t budget() const {
+    return m_budget;
+  }
+
+  void setBudget(size_t budget);
+
+  const static size_t DEFAULT_INTERVAL = 4;
+  const static size_t DEFAULT_BUDGET = 32 * 1024 * 1024;
+
+private:
+  typedef std::list<Checkpoint> CheckpointList;
+
+  static size_t prefixHash(osl_scop_p original, const TransformationSequence &sequence, size_t nbGroups);
+  CheckpointList::iterator lookup(size_t hash, osl_scop_p original,
+                                  const TransformationSequence &sequence, size_t nbGroups);
+  CheckpointList::iterator insert(size_t hash, osl_scop_p original,
+                                  const TransformationSequence &sequence, size_t nbGroups);
+  bool reserve(size_t bytes);
+  bool extend(CheckpointList::iterator checkpoint, size_t bytes);
+  void erase(CheckpointList::iterator checkpoint);
+  void evict(size_t budget);
+
+  size_t m_interval;
+  size_t m_budget;
+  size_t m_size = 0;
+
+  // Oldest entries first.
+  CheckpointList m_checkpoints;
+  std::unordered_multimap<size_t, CheckpointList::iterator> m_index;
+};
+
+#endif // CHECKPOINTSTORE_H
@@ -0,0 +1,265 @@
+#include "clastprinter.h"
+#include "macros.h"
+#include "oslutils.h"
+
+static long integerValue(cloog_int_t value) {
+  return cloog_int_get_si(value);
+}
+
+// Expressions that can be substituted into a statement body without parentheses.
+static bool isAtomic(struct clast_expr *expr) {
+  if (expr->type == clast_expr_name)
+    return true;
+  if (expr->type == clast_expr_term) {
+    struct clast_term *term = (struct clast_term *) expr;
+    if (term->var == nullptr)
+      return integerValue(term->val) >= 0;
+    return integerValue(term->val) == 1 && term->var->type == clast_expr_name;
+  }
+  if (expr->type == clast_expr_red) {
+    struct clast_reduction *reduction = (struct clast_reduction *) expr;
+    return reduction->n == 1 && isAtomic(reduction->elts[0]);
+  }
+  return false;
+}
+
+static bool isNegativeTerm(struct clast_expr *expr) {
+  return expr->type == clast_expr_term &&
+      integerValue(((struct clast_term *) expr)->val) < 0;
+}
+
+ClastPrinter::ClastPrinter(const std::vector<osl_statement_p> &statements,
+                           const std::vector<std::vector<int>> &betas) :
+  m_statements(statements), m_betas(betas) {
+  CLINT_ASSERT(statements.size() == betas.size(), "Each statement must have exactly one beta-vector");
+}
+
+std::string ClastPrinter::print(struct clast_stmt *root,
+                                std::multimap<std::vector<int>, std::pair<int, int>> &positions) {
+  m_code.clear();
+  m_positions = &positions;
+  printStatements(root, 0);
+  m_positions = nullptr;
+  return std::move(m_code);
+}
+
+void ClastPrinter::printIndent(int indent) {
+  m_code.append(2 * indent, ' ');
+}
+
+void ClastPrinter::printStatements(struct clast_stmt *stmt, int indent) {
+  for ( ; stmt != nullptr; stmt = stmt->next) {
+    if (CLAST_STMT_IS_A(stmt, stmt_root)) {
+      continue;
+    } else if (CLAST_STMT_IS_A(stmt, stmt_ass)) {
+      printAssignment((struct clast_assignment *) stmt, indent);
+    } else if (CLAST_STMT_IS_A(stmt, stmt_user)) {
+      printUserStatement((struct clast_user_stmt *) stmt, indent);
+    } else if (CLAST_STMT_IS_A(stmt, stmt_block)) {
+      printBlock((struct clast_block *) stmt, indent);
+    } else if (CLAST_STMT_IS_A(stmt, stmt_for)) {
+      printFor((struct clast_for *) stmt, indent);
+    } else if (CLAST_STMT_IS_A(stmt, stmt_guard)) {
+      printGuard((struct clast_guard *) stmt, indent);
+    } else {
+      CLINT_UNREACHABLE;
+    }
+  }
+}
+
+void ClastPrinter::printAssignment(struct clast_assignment *assignment, int indent) {
+  printIndent(indent);
+  if (assignment->LHS) {
+    m_code += assignment->LHS;
+    m_code += " = ";
+  }
+  printExpression(assignment->RHS);
+  m_code += ";\n";
+}
+
+void ClastPrinter::printBlock(struct clast_block *block, int indent) {
+  printIndent(indent);
+  m_code += "{\n";
+  printStatements(block->body, indent + 1);
+  printIndent(indent);
+  m_code += "}\n";
+}
+
+void ClastPrinter::printFor(struct clast_for *loop, int indent) {
+  printIndent(indent);
+  m_code += "for (";
+  if (loop->LB) {
+    m_code += loop->iterator;
+    m_code += "=";
+    printExpression(loop->LB);
+  }
+  m_code += ";";
+  if (loop->UB) {
+    m_code += loop->iterator;
+    m_code += "<=";
+    printExpression(loop->UB);
+  }
+  m_code += ";";
+  m_code += loop->iterator;
+  long stride = integerValue(loop->stride);
+  if (stride > 1) {
+    m_code += "+=";
+    m_code += std::to_string(stride);
+  } else {
+    m_code += "++";
+  }
+  m_code += ") {\n";
+  printStatements(loop->body, indent + 1);
+  printIndent(indent);
+  m_code += "}\n";
+}
+
+void ClastPrinter::printGuard(struct clast_guard *guard, int indent) {
+  printIndent(indent);
+  m_code += "if (";
+  for (int i = 0; i < guard->n; i++) {
+    if (i != 0)
+      m_code += " && ";
+    if (guard->n > 1)
+      m_code += "(";
+    printExpression(guard->eq[i].LHS);
+    if (guard->eq[i].sign == 0)
+      m_code += " == ";
+    else if (guard->eq[i].sign > 0)
+      m_code += " >= ";
+    else
+      m_code += " <= ";
+    printExpression(guard->eq[i].RHS);
+    if (guard->n > 1)
+      m_code += ")";
+  }
+  m_code += ") {\n";
+  printStatements(guard->then, indent + 1);
+  printIndent(indent);
+  m_code += "}\n";
+}
+
+void ClastPrinter::printUserStatement(struct clast_user_stmt *user, int indent) {
+  int index = user->statement->number - 1;
+  CLINT_ASSERT(index >= 0 && index < static_cast<int>(m_statements.size()),
+               "CLooG statement does not correspond to any OpenScop statement");
+
+  std::vector<std::string> substitutions;
+  for (struct clast_stmt *stmt = user->substitutions; stmt != nullptr; stmt = stmt->next) {
+    CLINT_ASSERT(CLAST_STMT_IS_A(stmt, stmt_ass), "Substitutions must be assignments");
+    struct clast_expr *expr = ((struct clast_assignment *) stmt)->RHS;
+    std::string code;
+    std::swap(code, m_code);
+    if (isAtomic(expr)) {
+      printExpression(expr);
+    } else {
+      m_code += "(";
+      printExpression(expr);
+      m_code += ")";
+    }
+    std::swap(code, m_code);
+    substitutions.push_back(std::move(code));
+  }
+
+  printIndent(indent);
+  int start = m_code.size();
+  m_code += oslStatementCode(m_statements[index], index + 1, substitutions);
+  m_positions->emplace(m_betas[index], std::make_pair(start, static_cast<int>(m_code.size())));
+  m_code += "\n";
+}
+
+void ClastPrinter::printExpression(struct clast_expr *expr) {
+  switch (expr->type) {
+  case clast_expr_name:
+    m_code += ((struct clast_name *) expr)->name;
+    break;
+  case clast_expr_term:
+    printTerm((struct clast_term *) expr);
+    break;
+  case clast_expr_red:
+    printReduction((struct clast_reduction *) expr);
+    break;
+  case clast_expr_bin:
+    printBinary((struct clast_binary *) expr);
+    break;
+  default:
+    CLINT_UNREACHABLE;
+  }
+}
+
+// Sums need parentheses when they are multiplied or divided.
+void ClastPrinter::printNestedExpression(struct clast_expr *expr) {
+  bool isSum = expr->type == clast_expr_red &&
+      ((struct clast_reduction *) expr)->type == clast_red_sum &&
+      ((struct clast_reduction *) expr)->n > 1;
+  if (isSum)
+    m_code += "(";
+  printExpression(expr);
+  if (isSum)
+    m_code += ")";
+}
+
+void ClastPrinter::printTerm(struct clast_term *term) {
+  long value = integerValue(term->val);
+  if (term->var == nullptr) {
+    m_code += std::to_string(value);
+    return;
+  }
+  if (value == -1) {
+    m_code += "-";
+  } else if (value != 1) {
+    m_code += std::to_string(value);
+    m_code += "*";
+  }
+  printNestedExpression(term->var);
+}
+
+void ClastPrinter::printReduction(struct clast_reduction *reduction) {
+  if (reduction->n == 1) {
+    printExpression(reduction->elts[0]);
+    return;
+  }
+
+  if (reduction->type == clast_red_sum) {
+    printExpression(reduction->elts[0]);
+    for (int i = 1; i < reduction->n; i++) {
+      // Negative terms are printed with their sign.
+      if (!isNegativeTerm(reduction->elts[i]))
+        m_code += "+";
+      printExpression(reduction->elts[i]);
+    }
+    return;
+  }
+
+  const char *function = reduction->type == clast_red_min ? "min(" : "max(";
+  for (int i = 0; i < reduction->n - 1; i++) {
+    m_code += function;
+    printExpression(reduction->elts[i]);
+    m_code += ",";
+  }
+  printExpression(reduction->elts[reduction->n - 1]);
+  m_code.append(reduction->n - 1, ')');
+}
+
+void ClastPrinter::printBinary(struct clast_binary *binary) {
+  long divisor = integerValue(binary->RHS);
+  switch (binary->type) {
+  case clast_bin_fdiv:
+  case clast_bin_cdiv:
+    m_code += binary->type == clast_bin_fdiv ? "floord(" : "ceild(";
+    printExpression(binary->LHS);
+    m_code += ",";
+    m_code += std::to_string(divisor);
+    m_code += ")";
+    break;
+  case clast_bin_div:
+  case clast_bin_mod:
+    m_code += "(";
+    printExpression(binary->LHS);
+    m_code += binary->type == clast_bin_div ? ")/" : ")%";
+    m_code += std::to_string(divisor);
+    break;
+  default:
+    CLINT_UNREACHABLE;
+  }
+}
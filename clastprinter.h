@@ -0,0 +1,52 @@
+#ifndef CLASTPRINTER_H
+#define CLASTPRINTER_H
+
+#include <osl/osl.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "oslutils.h"
+
+/**
+ * @brief C printer for the CLooG abstract syntax tree that records statement positions.
+ *
+ * The tree is walked once.  Statement bodies are taken from the OpenScop body extension with
+ * original iterators replaced by the substitution expressions.  The range of characters each
+ * statement occupies in the printed code is recorded together with the beta-vector of the
+ * statement.  The printer expects every CLooG statement to correspond to exactly one
+ * beta-vector, see oslReifyBetas.
+ */
+class ClastPrinter {
+public:
+  /// Statement number i of the CLooG program is @p statements[i - 1] with beta-vector @p betas[i - 1].
+  ClastPrinter(const std::vector<osl_statement_p> &statements,
+               const std::vector<std::vector<int>> &betas);
+
+  /// Print the tree rooted at @p root and add the positions of all statements to @p positions.
+  std::string print(struct clast_stmt *root, std::multimap<std::vector<int>, std::pair<int, int>> &positions);
+
+private:
+  void printStatements(struct clast_stmt *stmt, int indent);
+  void printAssignment(struct clast_assignment *assignment, int indent);
+  void printBlock(struct clast_block *block, int indent);
+  void printFor(struct clast_for *loop, int indent);
+  void printGuard(struct clast_guard *guard, int indent);
+  void printUserStatement(struct clast_user_stmt *user, int indent);
+
+  void printExpression(struct clast_expr *expr);
+  void printNestedExpression(struct clast_expr *expr);
+  void printTerm(struct clast_term *term);
+  void printReduction(struct clast_reduction *reduction);
+  void printBinary(struct clast_binary *binary);
+  void printIndent(int indent);
+
+  const std::vector<osl_statement_p> &m_statements;
+  const std::vector<std::vector<int>> &m_betas;
+  std::multimap<std::vector<int>, std::pair<int, int>> *m_positions = nullptr;
+  std::string m_code;
+};
+
+#endif // CLASTPRINTER_H
@@ -1,6 +1,53 @@
 #include "clintdependence.h"
 #include "clintstmtoccurrence.h"
 
+#include <isl/constraint.h>
+#include <isl/point.h>
+#include <isl/val.h>
+
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+long integerValue(__isl_take isl_val *val) {
+  CLINT_ASSERT(isl_val_is_int(val) == isl_bool_true, "Non-integer value in a constraint");
+  long value = isl_val_get_num_si(val);
+  isl_val_free(val);
+  return value;
+}
+
+template <typename Constraint>
+isl_stat collectConstraint(__isl_take isl_constraint *constraint, void *user) {
+  std::vector<Constraint> &part = *static_cast<std::vector<Constraint> *>(user);
+  int nbDims = isl_constraint_dim(constraint, isl_dim_set);
+  Constraint c;
+  c.equality = isl_constraint_is_equality(constraint) == isl_bool_true;
+  for (int i = 0; i < nbDims; i++) {
+    c.coefficients.push_back(integerValue(isl_constraint_get_coefficient_val(constraint, isl_dim_set, i)));
+  }
+  c.constant = integerValue(isl_constraint_get_constant_val(constraint));
+  part.push_back(std::move(c));
+  isl_constraint_free(constraint);
+  return isl_stat_ok;
+}
+
+template <typename Constraint>
+isl_stat collectPart(__isl_take isl_basic_set *part, void *user) {
+  std::vector<std::vector<Constraint>> &parts = *static_cast<std::vector<std::vector<Constraint>> *>(user);
+  // Existentially quantified variables cannot be evaluated on the coordinates alone.
+  if (isl_basic_set_dim(part, isl_dim_div) != 0) {
+    isl_basic_set_free(part);
+    return isl_stat_error;
+  }
+  parts.emplace_back();
+  isl_basic_set_foreach_constraint(part, &collectConstraint<Constraint>, &parts.back());
+  isl_basic_set_free(part);
+  return isl_stat_ok;
+}
+
+} // end anonymous namespace
+
 ClintDependence::ClintDependence(osl_dependence_p dependence,
                                  ClintStmtOccurrence *source,
                                  ClintStmtOccurrence *target,
@@ -13,31 +60,124 @@ ClintDependence::ClintDependence(osl_dependence_p dependence,
   CLINT_ASSERT(source->scop() == target->scop(), "Cross-scop dependences are not allowed");
 }
 
-std::vector<std::vector<int>>
-ClintDependence::projectOn(int horizontalDimIdx, int verticalDimIdx) {
-  // XXX: forward-incompatibility
-  CLINT_ASSERT(m_dependence->domain->next == nullptr,
-               "Union detected in dependence relation; probably Candl was updated. "
-               "Changed required in Clint to ensure compatibility.");
+ClintDependence::~ClintDependence() {
+  if (m_projectionRelation != nullptr)
+    osl_relation_free(m_projectionRelation);
+}
 
+std::vector<int> ClintDependence::projectionDimensions() const {
+  // Arrows are matched to occurrence points by their full coordinates, all domain dimensions are
+  // needed whatever the axes are.
   int nbSourceColumns = m_dependence->source_nb_output_dims_domain +
       m_dependence->source_nb_output_dims_access;
-  std::vector<int> visibleDimensions;
 
+  std::vector<int> dimensions;
   for (int i = 0; i < m_dependence->source_nb_output_dims_domain; i++) {
-    visibleDimensions.push_back(i);
+    dimensions.push_back(i);
   }
   for (int i = 0; i < m_dependence->target_nb_output_dims_domain; i++) {
-    visibleDimensions.push_back(nbSourceColumns + i);
+    dimensions.push_back(nbSourceColumns + i);
   }
+  return std::move(dimensions);
+}
+
+osl_relation_p ClintDependence::projectionRelation() {
+  if (m_projectionRelation != nullptr)
+    return m_projectionRelation;
+
+  // XXX: forward-incompatibility
+  CLINT_ASSERT(m_dependence->domain->next == nullptr,
+               "Union detected in dependence relation; probably Candl was updated. "
+               "Changed required in Clint to ensure compatibility.");
 
   osl_relation_p domain = osl_relation_nclone(m_dependence->domain, 1);
   domain->nb_output_dims += domain->nb_input_dims;
   domain->nb_input_dims = 0;
-  osl_relation_p ready = oslRelationWithContext(domain, m_source->scop()->fixedContext());
+  m_projectionRelation = oslRelationWithContext(domain, m_source->scop()->fixedContext());
   osl_relation_free(domain);
-  std::vector<std::vector<int>> projection =
-      m_source->program()->enumerator()->enumerate(ready, visibleDimensions);
-  return projection;
+  return m_projectionRelation;
+}
+
+PointBuffer ClintDependence::projectedPoints() {
+  return m_source->program()->enumerator()->enumerate(projectionRelation(), projectionDimensions());
 }
 
+void ClintDependence::summarize() {
+  m_summarized = true;
+  if (m_dependence->domain->next != nullptr ||
+      sourceDimensionality() != targetDimensionality())
+    return;
+
+  // Source domain dimensions go to the input, target domain dimensions to the output.  Parameters
+  // are fixed by the context and can be projected out exactly.
+  int nbSourceColumns = m_dependence->source_nb_output_dims_domain +
+      m_dependence->source_nb_output_dims_access;
+  isl_map *map = isl_map_from_range(ISLEnumerator::setFromOSLRelation(projectionRelation()));
+  map = isl_map_move_dims(map, isl_dim_in, 0, isl_dim_out, 0, nbSourceColumns);
+  map = isl_map_project_out(map, isl_dim_in, m_dependence->source_nb_output_dims_domain,
+                            m_dependence->source_nb_output_dims_access);
+  map = isl_map_project_out(map, isl_dim_out, m_dependence->target_nb_output_dims_domain,
+                            m_dependence->target_nb_output_dims_access);
+  map = isl_map_project_out(map, isl_dim_param, 0, isl_map_dim(map, isl_dim_param));
+
+  isl_set *deltas = isl_map_deltas(isl_map_copy(map));
+  bool uniform = false;
+  if (isl_set_is_empty(deltas) == isl_bool_false) {
+    isl_point *sample = isl_set_sample_point(isl_set_copy(deltas));
+    isl_set *single = isl_set_from_point(isl_point_copy(sample));
+    uniform = isl_set_is_equal(single, deltas) == isl_bool_true;
+    for (int i = 0, e = isl_set_dim(deltas, isl_dim_set); uniform && i < e; i++) {
+      isl_val *val = isl_point_get_coordinate_val(sample, isl_dim_set, i);
+      long value = isl_val_get_num_si(val);
+      CLINT_ASSERT(isl_val_get_den_si(val) == 1, "Fractional distance");
+      CLINT_ASSERT(value <= INT_MAX && value >= INT_MIN, "Integer overflow");
+      m_distance.push_back(static_cast<int>(value));
+      isl_val_free(val);
+    }
+    isl_set_free(single);
+    isl_point_free(sample);
+  }
+  isl_set_free(deltas);
+
+  // With a single distance, the relation is entirely defined by the set of its sources.
+  if (uniform) {
+    isl_set *sources = isl_set_coalesce(isl_map_domain(isl_map_copy(map)));
+    uniform = isl_set_foreach_basic_set(sources, &collectPart<Constraint>, &m_sourceDomain) == isl_stat_ok;
+    isl_set_free(sources);
+  }
+  isl_map_free(map);
+
+  m_uniform = uniform;
+  if (!uniform) {
+    m_distance.clear();
+    m_sourceDomain.clear();
+  }
+}
+
+bool ClintDependence::isUniform() {
+  if (!m_summarized)
+    summarize();
+  return m_uniform;
+}
+
+const std::vector<int> &ClintDependence::distance() {
+  CLINT_ASSERT(isUniform(), "Only uniform dependences have a distance vector");
+  return m_distance;
+}
+
+bool ClintDependence::hasSourceInstance(const std::vector<int> &sourceCoordinates) {
+  CLINT_ASSERT(isUniform(), "Only uniform dependences are described by their sources");
+  CLINT_ASSERT(sourceCoordinates.size() == m_distance.size(), "Source coordinates dimensionality mismatch");
+  for (const std::vector<Constraint> &part : m_sourceDomain) {
+    bool contains = std::all_of(std::begin(part), std::end(part), [&sourceCoordinates](const Constraint &c) {
+      long value = c.constant;
+      for (size_t i = 0; i < c.coefficients.size(); i++) {
+        value += c.coefficients[i] * sourceCoordinates[i];
+      }
+      return c.equality ? value == 0 : value >= 0;
+    });
+    if (contains)
+      return true;
+  }
+  return false;
+}
@@ -3,6 +3,10 @@
 
 #include <QObject>
 #include "oslutils.h"
+#include "enumerator.h"
+#include "pointbuffer.h"
+
+#include <vector>
 
 class ClintStmtOccurrence;
 
@@ -13,7 +17,14 @@ public:
                            ClintStmtOccurrence *target, bool violated,
                            QObject *parent = nullptr);
 
-  std::vector<std::vector<int>> projectOn(int horizontalDimIdx, int verticalDimIdx);
+  ~ClintDependence();
+
+  /// Source and target domain coordinates of all dependence instances.  Arrows are matched to the
+  /// points by their full coordinates, so the projection does not depend on the axes and is shared
+  /// by all projections through the cache of the program enumerator.  The relation they are
+  /// enumerated from is built once: the dependence and the fixed context of the scop never change,
+  /// a modified dependence is a new object.
+  PointBuffer projectedPoints();
 
   int sourceDimensionality() const {
     return m_dependence->source_nb_output_dims_domain;
@@ -35,6 +46,26 @@ public:
     return m_violated;
   }
 
+  /// Dependences are kept between analyses as long as their occurrences are, only the legality changes.
+  void setViolated(bool violated) {
+    m_violated = violated;
+  }
+
+  osl_dependence_p oslDependence() const {
+    return m_dependence;
+  }
+
+  /// A dependence is uniform if each target instance is its source instance translated by the
+  /// same distance vector for the fixed parameter values.  Its instances can then be drawn from
+  /// the source points without enumerating the dependence relation.
+  bool isUniform();
+
+  /// Distance vector of a uniform dependence in the domain dimensions.
+  const std::vector<int> &distance();
+
+  /// Whether the uniform dependence has an instance with source @p sourceCoordinates.
+  bool hasSourceInstance(const std::vector<int> &sourceCoordinates);
+
 signals:
 
 public slots:
@@ -42,6 +73,24 @@ public slots:
 private:
   osl_dependence_p m_dependence;
 
+  std::vector<int> projectionDimensions() const;
+  osl_relation_p projectionRelation();
+
+  osl_relation_p m_projectionRelation = nullptr;
+
+  void summarize();
+
+  struct Constraint {
+    bool equality;
+    std::vector<long> coefficients;
+    long constant;
+  };
+
+  bool m_summarized = false;
+  bool m_uniform = false;
+  std::vector<int> m_distance;
+  std::vector<std::vector<Constraint>> m_sourceDomain; ///< Union of parts, constraints in each part.
+
   ClintStmtOccurrence *m_source;
   ClintStmtOccurrence *m_target;
 
@@ -5,6 +5,12 @@
 
 ClintProgram::ClintProgram(osl_scop_p scop, char *originalCode, QObject *parent) :
   QObject(parent), m_scop(scop) {
+  // Scops store their initial checkpoint and connect to the workers on construction.
+  m_checkpoints = new CheckpointStore;
+  m_legality = new LegalityCache;
+  m_worker = new TransformationWorker;
+  m_codeWorker = new TransformationWorker;
+  m_previewWorker = new TransformationWorker;
 
   // TODO: factory that concentrates osl-related creation?
   // AZ: I think it is okay for general objects (program, scop, stmt, stmtoccurence) to use osl.
@@ -15,9 +21,18 @@ ClintProgram::ClintProgram(osl_scop_p scop, char *originalCode, QObject *parent)
     m_scops.push_back(vizScop);
   });
 
-  m_enumerator = new ISLEnumerator;
+  m_enumerator = new CachingEnumerator(new ISLEnumerator);
 }
 
 ClintProgram::~ClintProgram() {
+  // Scops are destroyed after the program as its children and must not see dangling workers.
+  delete m_worker;
+  delete m_codeWorker;
+  delete m_previewWorker;
+  m_worker = nullptr;
+  m_codeWorker = nullptr;
+  m_previewWorker = nullptr;
   delete m_enumerator;
+  delete m_checkpoints;
+  delete m_legality;
 }
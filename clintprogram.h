@@ -6,7 +6,10 @@
 #include <QSet>
 #include <QVector>
 
+#include "checkpointstore.h"
 #include "enumerator.h"
+#include "legalitycache.h"
+#include "transformationworker.h"
 
 class ClintStmt;
 class ClintScop;
@@ -30,6 +33,32 @@ public:
     return m_enumerator;
   }
 
+  /// Transformed scop snapshots shared by all scops of the program, survive scop regeneration.
+  CheckpointStore *checkpoints() const {
+    return m_checkpoints;
+  }
+
+  /// Dependence analysis results shared by all scops of the program, survive scop regeneration.
+  LegalityCache *legalityCache() const {
+    return m_legality;
+  }
+
+  /// Background thread executing transformation sequences of the program's scops.
+  TransformationWorker *transformationWorker() const {
+    return m_worker;
+  }
+
+  /// Background thread generating code for the program's scops, separate so that it does not cancel executions.
+  TransformationWorker *codeGenerationWorker() const {
+    return m_codeWorker;
+  }
+
+  /// Background thread checking the legality of transformations while they are dragged, separate so that it does not cancel executions.
+  /// It runs Candl concurrently with the other workers only through CandlAnalyzer, which serializes the calls.
+  TransformationWorker *legalityPreviewWorker() const {
+    return m_previewWorker;
+  }
+
   ClintScop *&operator [](int idx) {
     CLINT_ASSERT(idx < m_scops.size(), "Indexed access out of bounds");
     return m_scops[idx];
@@ -51,7 +80,12 @@ private:
 
   osl_scop_p m_scop;
 
-  Enumerator *m_enumerator;
+  CachingEnumerator *m_enumerator;
+  CheckpointStore *m_checkpoints;
+  LegalityCache *m_legality;
+  TransformationWorker *m_worker;
+  TransformationWorker *m_codeWorker;
+  TransformationWorker *m_previewWorker;
 };
 
 #endif // CLINTPROGRAM_H
@@ -14,19 +14,20 @@
 
 #include <QColor>
 #include <QString>
+#include <QTimer>
 #include "vizproperties.h"
 #include "dependenceanalyzer.h"
 
-void ClintScop::clearDependences() {
+// Dependences between the same occurrences keep their objects, the others are created or deleted.
+void ClintScop::processDependenceMap(const DependenceAnalyzer::DependenceMap &dependenceMap) {
+  std::multimap<std::tuple<osl_dependence_p, ClintStmtOccurrence *, ClintStmtOccurrence *>, ClintDependence *> previous;
   for (auto it : m_dependenceMap) {
-    it.second->setParent(nullptr);
-    delete it.second;
+    ClintDependence *clintDep = it.second;
+    previous.emplace(std::make_tuple(clintDep->oslDependence(), clintDep->source(), clintDep->target()), clintDep);
   }
   m_dependenceMap.clear();
   m_internalDeps.clear();
-}
 
-void ClintScop::processDependenceMap(const DependenceAnalyzer::DependenceMap &dependenceMap) {
   for (auto element : dependenceMap) {
     std::pair<std::vector<int>, std::vector<int>> betas = element.first;
     osl_dependence_p dependence = element.second.first;
@@ -39,21 +40,46 @@ void ClintScop::processDependenceMap(const DependenceAnalyzer::DependenceMap &de
       for (auto targetBeta : mappedTargetBetas) {
         ClintStmtOccurrence *source = occurrence(sourceBeta);
         ClintStmtOccurrence *target = occurrence(targetBeta);
-        ClintDependence *clintDep = new ClintDependence(dependence, source, target, isViolated, this);
+        ClintDependence *clintDep;
+        auto found = previous.find(std::make_tuple(dependence, source, target));
+        if (found != previous.end()) {
+          clintDep = found->second;
+          clintDep->setViolated(isViolated);
+          previous.erase(found);
+        } else {
+          clintDep = new ClintDependence(dependence, source, target, isViolated, this);
+        }
         m_dependenceMap.emplace(std::make_pair(sourceBeta, targetBeta), clintDep);
       }
     }
   }
+
+  for (auto it : previous) {
+    it.second->setParent(nullptr);
+    delete it.second;
+  }
+  m_analyzedDependences = dependenceMap;
 }
 
-void ClintScop::createDependences(osl_scop_p scop) {
-  clearDependences();
-  processDependenceMap(m_analyzer->analyze(scop));
+DependenceAnalyzer::DependenceMap ClintScop::createDependences(osl_scop_p scop) {
+  DependenceAnalyzer::DependenceMap dependenceMap = m_analyzer->analyze(scop);
+  processDependenceMap(dependenceMap);
+  return std::move(dependenceMap);
 }
 
-void ClintScop::updateDependences(osl_scop_p transformed) {
-  clearDependences();
-  processDependenceMap(m_analyzer->analyze(m_scopPart, transformed));
+// Must be called before the transformed scop is replaced, the previous one is the base of the
+// incremental analysis.
+DependenceAnalyzer::DependenceMap ClintScop::updateDependences(osl_scop_p transformed) {
+  // Scops reached again, e.g. by undo or by a different sequence, are not analyzed again.
+  LegalityCache *cache = legalityCache();
+  DependenceAnalyzer::DependenceMap dependenceMap;
+  if (cache == nullptr || !cache->find(m_scopPart, transformed, dependenceMap)) {
+    dependenceMap = m_analyzer->reanalyze(m_scopPart, transformed, analyzedScop(), m_analyzedDependences);
+    if (cache != nullptr)
+      cache->store(m_scopPart, transformed, dependenceMap);
+  }
+  processDependenceMap(dependenceMap);
+  return std::move(dependenceMap);
 }
 
 static inline void replaceNewlinesHtml(std::string &str) {
@@ -81,18 +107,51 @@ ClintScop::ClintScop(osl_scop_p scop, int parameterValue, char *originalCode, Cl
   m_transformer = new ClayTransformer;
   m_scriptGenerator = new ClayScriptGenerator(m_scriptStream);
   m_betaMapper = new ClayBetaMapper(this);
-  m_analyzer = new CandlAnalyzer;
-
-  createDependences(scop);
+  m_analyzer = DependenceAnalyzer::create(DependenceAnalyzer::backend());
+  m_codeGenerationTimer = new QTimer(this);
+  m_codeGenerationTimer->setSingleShot(true);
+  m_codeGenerationTimer->setInterval(DEFAULT_CODE_GENERATION_DELAY);
+  connect(m_codeGenerationTimer, &QTimer::timeout, this, &ClintScop::generateCode);
+  if (m_program != nullptr) {
+    connect(m_program->transformationWorker(), &TransformationWorker::executed,
+            this, &ClintScop::transformationExecuted);
+    connect(m_program->codeGenerationWorker(), &TransformationWorker::executed,
+            this, &ClintScop::codeGenerated);
+    connect(m_program->legalityPreviewWorker(), &TransformationWorker::executed,
+            this, &ClintScop::legalityPreviewExecuted);
+  }
 
-  m_generatedCode = oslToCCode(m_scopPart);
+  // Scops rebuilt for the same original reuse its dependences and code from the initial checkpoint.
+  CheckpointStore *store = checkpoints();
+  const CheckpointStore::Checkpoint *initial =
+      store != nullptr ? store->find(m_scopPart, m_transformationSeq, 0) : nullptr;
+  if (initial != nullptr && initial->scop != nullptr) {
+    processDependenceMap(initial->dependences);
+  } else {
+    DependenceAnalyzer::DependenceMap dependenceMap = createDependences(scop);
+    if (store != nullptr) {
+      store->store(m_scopPart, m_transformationSeq, 0, m_scopPart, dependenceMap);
+      initial = store->find(m_scopPart, m_transformationSeq, 0);
+    }
+  }
+  bool hasCachedCode = initial != nullptr && initial->hasCode;
   m_currentScript = (char *) malloc(sizeof(char));
   m_currentScript[0] = '\0';
 
   if (originalCode == nullptr) {
+    if (hasCachedCode) {
+      m_generatedCode = strdup(initial->generatedCode.c_str());
+      m_originalHtml = initial->generatedHtml;
+    } else {
+      // Generates the code and the statement positions at once.
+      updateGeneratedHtml(m_scopPart, m_originalHtml);
+      if (store != nullptr) {
+        store->storeCode(m_scopPart, m_transformationSeq, 0, m_generatedCode, m_originalHtml);
+      }
+    }
     m_originalCode = strdup(m_generatedCode);
-    updateGeneratedHtml(m_scopPart, m_originalHtml);
   } else {
+    m_generatedCode = hasCachedCode ? strdup(initial->generatedCode.c_str()) : oslToCCode(m_scopPart);
     m_originalCode = strdup(originalCode);
     m_originalHtml = std::string(escapeHtml(originalCode));
 
@@ -101,6 +160,16 @@ ClintScop::ClintScop(osl_scop_p scop, int parameterValue, char *originalCode, Cl
 }
 
 ClintScop::~ClintScop() {
+  // Results of jobs still in flight would stay in the workers under a dangling owner.
+  if (m_program != nullptr) {
+    for (TransformationWorker *worker : {m_program->transformationWorker(),
+                                         m_program->codeGenerationWorker(),
+                                         m_program->legalityPreviewWorker()}) {
+      if (worker != nullptr)
+        worker->cancel(this);
+    }
+  }
+
   delete m_transformer;
   delete m_scriptGenerator;
   delete m_betaMapper;
@@ -111,12 +180,24 @@ ClintScop::~ClintScop() {
   free(m_originalCode);
 
   appliedScopFlushCache();
+  if (m_transformedScop != nullptr)
+    osl_scop_free(m_transformedScop);
 }
 
 osl_scop_p ClintScop::appliedScop() {
   if (m_appliedScopCache == nullptr) {
-    m_appliedScopCache = osl_scop_clone(m_scopPart);
-    m_transformer->apply(m_appliedScopCache, m_transformationSeq);
+    if (m_transformedScop == nullptr || m_transformedScopStale) {
+      m_appliedScopCache = osl_scop_clone(m_scopPart);
+      for (const TransformationGroup &group : canonicalGroups(m_transformationSeq.groups)) {
+        m_transformer->apply(m_appliedScopCache, group);
+      }
+    } else {
+      // Only the groups added after the last execution are missing from the transformed scop.
+      m_appliedScopCache = osl_scop_clone(m_transformedScop);
+      for (const TransformationGroup &group : canonicalGroups(m_transformationSeq.groups, m_transformedGroups)) {
+        m_transformer->apply(m_appliedScopCache, group);
+      }
+    }
   }
   return m_appliedScopCache;
 }
@@ -135,41 +216,67 @@ inline std::string rgbColorText(QColor clr) {
 }
 
 void ClintScop::updateGeneratedHtml(osl_scop_p transformedScop, std::string &string) {
-  std::map<std::pair<int, int>, std::vector<int>> betasAtPos;
-
-  std::multimap<std::vector<int>, std::pair<int, int>> positions = stmtPositionsInHtml(transformedScop);
-  for (auto it : positions) {
-    betasAtPos.emplace(it.second, canonicalOriginalBetaVector(it.first));
-  }
-
+  std::multimap<std::vector<int>, std::pair<int, int>> positions;
   if (m_generatedCode != nullptr)
     free(m_generatedCode);
-  m_generatedCode = oslToCCode(transformedScop);
+  m_generatedCode = oslToCCode(transformedScop, positions);
+  updateGeneratedHtml(positions, string);
+}
+
+void ClintScop::updateScript() {
   if (m_currentScript != nullptr)
     free(m_currentScript);
-  m_scriptGenerator->apply(m_scopPart, m_transformationSeq);
+  m_scriptGenerator->apply(m_scopPart, canonicalSequence(m_transformationSeq));
   m_currentScript = strdup(m_scriptStream.str().c_str());
   m_scriptStream.str(std::string());
   m_scriptStream.clear();
+}
 
-  char *generatedCode = escapeHtml(m_generatedCode);
-  char *currentPtr = generatedCode;
+// Append the characters [begin, end) of the code to the HTML, indentation is made non-breaking.
+static void appendEscapedHtml(std::stringstream &html, const char *begin, const char *end, bool &lineStart) {
+  for (const char *c = begin; c != end; ++c) {
+    if (lineStart && (*c == ' ' || *c == '\t')) {
+      html << "&nbsp;";
+      continue;
+    }
+    lineStart = *c == '\n';
+    if (*c == '<')
+      html << "&lt;";
+    else if (*c == '>')
+      html << "&gt;";
+    else
+      html << *c;
+  }
+}
+
+// Color the statements of m_generatedCode at the given positions in the code.
+void ClintScop::updateGeneratedHtml(const std::multimap<std::vector<int>, std::pair<int, int>> &positions,
+                                    std::string &string) {
+  std::map<std::pair<int, int>, std::vector<int>> betasAtPos;
+  for (auto it : positions) {
+    betasAtPos.emplace(it.second, canonicalOriginalBetaVector(it.first));
+  }
+
+  const char *generatedCode = m_generatedCode;
+  int length = strlen(generatedCode);
+  int current = 0;
+  bool lineStart = false;
   VizProperties *props = new VizProperties;  // FIXME: this does not belong to here, access it elsewhere
   std::stringstream html;
   for (auto it : betasAtPos) {
-    if (it.first.first < (currentPtr - generatedCode)||
-        it.first.first > it.first.second) {
+    if (it.first.first < current ||
+        it.first.first > it.first.second ||
+        it.first.second > length) {
       qDebug() << "Code positions are wrong";
       break;
     }
-    html << std::string(currentPtr, it.first.first - (currentPtr - generatedCode));
-    currentPtr = generatedCode + it.first.first;
+    appendEscapedHtml(html, generatedCode + current, generatedCode + it.first.first, lineStart);
     html << "<span style=\"color: rgb(" << rgbColorText(props->color(it.second)) << ");\">";
-    html << std::string(currentPtr, (it.first.second - it.first.first));
-    currentPtr = generatedCode + it.first.second;
+    appendEscapedHtml(html, generatedCode + it.first.first, generatedCode + it.first.second, lineStart);
     html << "</span>";
+    current = it.first.second;
   }
-  html << std::string(currentPtr);
+  appendEscapedHtml(html, generatedCode + current, generatedCode + length, lineStart);
   string.clear();
   string = html.str();
 
@@ -190,46 +297,95 @@ void ClintScop::resetOccurrences(osl_scop_p transformed) {
   });
 }
 
+// Create or remove the occurrence to reflect the ISS/Collapse result.
+void ClintScop::updateOccurrenceStructure(const Transformation &transformation) {
+  // XXX: this assumes loop contains only one statement, and makes assumptions on beta-structure.
+  // It is true for the transformation sequences created by VizManipulationManager.
+  if (transformation.kind() == Transformation::Kind::IndexSetSplitting) {
+    std::vector<int> loopBeta = transformation.target();
+    loopBeta.push_back(0);
+    ClintStmtOccurrence *occ = occurrence(loopBeta);
+    loopBeta.back() = 1;
+    occ->statement()->splitOccurrence(occ, loopBeta);
+    m_vizBetaMap[loopBeta] = occ->statement();                 // The subsequent call to resetOccurrences will replace the statement anyway
+  } else if (transformation.kind() == Transformation::Kind::Collapse) {
+    std::vector<int> loopBeta = transformation.target();
+    loopBeta.push_back(1);
+    ClintStmtOccurrence *occ = occurrence(loopBeta);
+    occ->statement()->removeOccurrence(occ);
+    m_vizBetaMap.erase(loopBeta);
+  }
+}
+
+// Copy of the closest scop to start the execution of the sequence from, @p firstGroup is the
+// number of groups already applied to it.
+osl_scop_p ClintScop::cloneExecutionBase(size_t &firstGroup) {
+  if (m_transformedScop != nullptr && !m_transformedScopStale) {
+    firstGroup = m_transformedGroups;
+    return osl_scop_clone(m_transformedScop);
+  }
+  CheckpointStore *store = checkpoints();
+  const CheckpointStore::Checkpoint *checkpoint =
+      store != nullptr ? store->nearest(m_scopPart, m_transformationSeq) : nullptr;
+  if (checkpoint != nullptr) {
+    firstGroup = checkpoint->groups.size();
+    return osl_scop_clone(checkpoint->scop);
+  }
+  firstGroup = 0;
+  return osl_scop_clone(m_scopPart);
+}
+
 void ClintScop::executeTransformationSequence() {
-  // XXX: speed/memory+code_quality tradeoff
-  // ClintScop stores the original (non-transfomed) scop and we perform the entire transformation sequence after each action
-  // However, it may store the current transformed scop along with the original (original is still needed for, e.g., undo)
-  // and perform only the transformations from the last group that is identifiable by m_groupsExecuted.
-  osl_scop_p transformed = osl_scop_clone(m_scopPart);
-  size_t groupsExecuted = 0;
-  for (const TransformationGroup &group : m_transformationSeq.groups) {
-    for (const Transformation &transformation : group.transformations) {
-      m_transformer->apply(transformed, transformation);
-
-      if (groupsExecuted >= m_groupsExecuted) {
-        // Create the occurrence to reflect the ISS/Collapse result.
-        // XXX: this assumes loop contains only one statement, and makes assumptions on beta-structure.
-        // It is true for the transformation sequences created by VizManipulationManager.
-        if (transformation.kind() == Transformation::Kind::IndexSetSplitting) {
-          std::vector<int> loopBeta = transformation.target();
-          loopBeta.push_back(0);
-          ClintStmtOccurrence *occ = occurrence(loopBeta);
-          loopBeta.back() = 1;
-          occ->statement()->splitOccurrence(occ, loopBeta);
-          m_vizBetaMap[loopBeta] = occ->statement();                 // The subsequent call to resetOccurrences will replace the statement anyway
-        } else if (transformation.kind() == Transformation::Kind::Collapse) {
-          std::vector<int> loopBeta = transformation.target();
-          loopBeta.push_back(1);
-          ClintStmtOccurrence *occ = occurrence(loopBeta);
-          occ->statement()->removeOccurrence(occ);
-          m_vizBetaMap.erase(loopBeta);
-        }
-      }
+  // ClintScop keeps the transformed scop of the previous execution and only applies the groups
+  // added since then to its copy.  Occurrences refer to the statements of the transformed scop,
+  // so the previous one is freed only after they were reset.  If groups were removed since the
+  // previous execution, or the scop was rebuilt, the sequence is replayed from the nearest
+  // checkpoint of the program, or from the original scop if there is none.
+  cancelExecution();
+  CheckpointStore *store = checkpoints();
+  size_t nbGroups = m_transformationSeq.groups.size();
+  size_t firstGroup;
+  osl_scop_p transformed = cloneExecutionBase(firstGroup);
+
+  // The scop only needs the minimized remainder of the sequence.  Groups restored from a checkpoint
+  // or merged away are not applied, but the occurrences still have to reflect the ISS/Collapse
+  // they contain.
+  for (const TransformationGroup &group : canonicalGroups(m_transformationSeq.groups, firstGroup)) {
+    m_transformer->apply(transformed, group);
+  }
+  for (size_t groupIdx = m_groupsExecuted; groupIdx < nbGroups; ++groupIdx) {
+    for (const Transformation &transformation : m_transformationSeq.groups[groupIdx].transformations) {
+      updateOccurrenceStructure(transformation);
     }
-    ++groupsExecuted;
   }
   resetOccurrences(transformed);
-  m_groupsExecuted = groupsExecuted;
+  m_groupsExecuted = nbGroups;
+
+  // Dependences only depend on the sequence, take them from the checkpoint if there is one.
+  const CheckpointStore::Checkpoint *checkpoint =
+      store != nullptr ? store->find(m_scopPart, m_transformationSeq, nbGroups) : nullptr;
+  if (checkpoint != nullptr && checkpoint->scop != nullptr) {
+    processDependenceMap(checkpoint->dependences);
+  } else {
+    DependenceAnalyzer::DependenceMap dependenceMap = updateDependences(transformed);
+    if (store != nullptr && store->isCheckpoint(nbGroups)) {
+      store->store(m_scopPart, m_transformationSeq, nbGroups, transformed, dependenceMap);
+    }
+  }
+
+  if (m_transformedScop != nullptr)
+    osl_scop_free(m_transformedScop);
+  m_transformedScop = transformed;
+  m_transformedGroups = nbGroups;
+  m_transformedScopStale = false;
 
-  updateDependences(transformed);
-  updateGeneratedHtml(transformed, m_generatedHtml);
+  updateScript();
+  scheduleCodeGeneration();
   appliedScopFlushCache();
+  finishExecution();
+}
 
+void ClintScop::finishExecution() {
   emit transformExecuted();
   bool dimensionNbChanged =
       std::find_if(std::begin(m_transformationSeq.groups), std::end(m_transformationSeq.groups),
@@ -247,6 +403,147 @@ void ClintScop::executeTransformationSequence() {
   }
 }
 
+void ClintScop::executeTransformationSequenceAsync(std::function<void ()> completion) {
+  TransformationWorker *worker = m_program != nullptr ? m_program->transformationWorker() : nullptr;
+  if (worker == nullptr) {
+    executeTransformationSequence();
+    if (completion)
+      completion();
+    return;
+  }
+
+  // Occurrence structure only depends on the sequence and is updated immediately; the GUI keeps
+  // showing the previous transformed scop until the worker result arrives.  The job starts from
+  // the same scop executeTransformationSequence would, but owns copies of everything it reads.
+  size_t nbGroups = m_transformationSeq.groups.size();
+  TransformationWorker::Job job;
+  job.owner = this;
+  job.original = osl_scop_clone(m_scopPart);
+  job.scopPart = m_scopPart;
+  job.legality = legalityCache();
+  job.analyzed = osl_scop_clone(analyzedScop());
+  job.analyzedDependences = m_analyzedDependences;
+  job.groups = m_transformationSeq.groups;
+  job.base = cloneExecutionBase(job.firstGroup);
+  job.generateCode = false;
+
+  for (size_t groupIdx = m_groupsExecuted; groupIdx < nbGroups; ++groupIdx) {
+    for (const Transformation &transformation : m_transformationSeq.groups[groupIdx].transformations) {
+      updateOccurrenceStructure(transformation);
+    }
+  }
+  m_groupsExecuted = nbGroups;
+
+  m_executionGeneration = worker->submit(std::move(job));
+  m_executionPending = true;
+  m_executionCompletion = completion;
+}
+
+void ClintScop::cancelExecution() {
+  if (!m_executionPending)
+    return;
+  m_program->transformationWorker()->cancel(this);
+  m_executionPending = false;
+  m_executionCompletion = std::function<void ()>();
+}
+
+void ClintScop::transformationExecuted() {
+  if (!m_executionPending)
+    return;
+  TransformationWorker::Result result;
+  if (!m_program->transformationWorker()->takeResult(this, m_executionGeneration, result))
+    return;
+  m_executionPending = false;
+  std::function<void ()> completion = std::move(m_executionCompletion);
+  m_executionCompletion = std::function<void ()>();
+
+  // Clay failed on the worker, execute synchronously to report the error as usual.
+  if (result.transformed == nullptr) {
+    executeTransformationSequence();
+    if (completion)
+      completion();
+    return;
+  }
+
+  resetOccurrences(result.transformed);
+  if (m_transformedScop != nullptr)
+    osl_scop_free(m_transformedScop);
+  m_transformedScop = result.transformed;
+  m_transformedGroups = result.nbGroups;
+  m_transformedScopStale = false;
+
+  processDependenceMap(result.dependences);
+
+  CheckpointStore *store = checkpoints();
+  if (store != nullptr && store->isCheckpoint(result.nbGroups)) {
+    store->store(m_scopPart, m_transformationSeq, result.nbGroups, m_transformedScop, result.dependences);
+  }
+  updateScript();
+  scheduleCodeGeneration();
+  appliedScopFlushCache();
+  finishExecution();
+  if (completion)
+    completion();
+}
+
+unsigned ClintScop::previewLegality(const TransformationGroup &group) {
+  TransformationWorker *worker = m_program != nullptr ? m_program->legalityPreviewWorker() : nullptr;
+  if (worker == nullptr)
+    return 0;
+
+  // Same job as an execution with the group appended, the analysis only rechecks the dependences
+  // of the statements the group changes, and the legality cache remembers previous drags.
+  TransformationWorker::Job job;
+  job.owner = this;
+  job.original = osl_scop_clone(m_scopPart);
+  job.scopPart = m_scopPart;
+  job.legality = legalityCache();
+  job.analyzed = osl_scop_clone(analyzedScop());
+  job.analyzedDependences = m_analyzedDependences;
+  job.groups = m_transformationSeq.groups;
+  job.groups.push_back(group);
+  job.base = cloneExecutionBase(job.firstGroup);
+  job.generateCode = false;
+
+  m_previewGeneration = worker->submit(std::move(job));
+  m_previewPending = true;
+  return m_previewGeneration;
+}
+
+void ClintScop::cancelLegalityPreview() {
+  if (!m_previewPending)
+    return;
+  m_program->legalityPreviewWorker()->cancel(this);
+  m_previewPending = false;
+}
+
+void ClintScop::legalityPreviewExecuted() {
+  if (!m_previewPending)
+    return;
+  TransformationWorker::Result result;
+  if (!m_program->legalityPreviewWorker()->takeResult(this, m_previewGeneration, result))
+    return;
+  m_previewPending = false;
+
+  // Clay failing to apply the group makes it illegal as well.
+  bool legal = result.transformed != nullptr;
+  if (legal) {
+    std::map<std::pair<std::vector<int>, std::vector<int>>, int> nbViolated;
+    for (const auto &element : m_analyzedDependences) {
+      if (element.second.second)
+        nbViolated[element.first]++;
+    }
+    for (const auto &element : result.dependences) {
+      if (element.second.second && --nbViolated[element.first] < 0) {
+        legal = false;
+        break;
+      }
+    }
+    osl_scop_free(result.transformed);
+  }
+  emit legalityPreviewed(m_previewGeneration, legal);
+}
+
 std::unordered_set<ClintStmt *> ClintScop::statements() const {
   std::unordered_set<ClintStmt *> stmts;
   for (auto value : m_vizBetaMap)
@@ -273,6 +570,36 @@ std::unordered_set<ClintStmtOccurrence *> ClintScop::occurrences(const std::vect
   return std::move(found);
 }
 
+/// Enumerate the points of all occurrences that do not have them yet in one batch so
+/// that the enumerator may process them concurrently.  Occurrences derive all their
+/// projections from these points.  Occurrences that will be clipped to the viewport in the
+/// projection on (@p horizontalDimIdx, @p verticalDimIdx) are skipped, they only enumerate
+/// the points around the viewport.
+void ClintScop::prefetchPoints(int horizontalDimIdx, int verticalDimIdx, int clippingThreshold) {
+  std::vector<ClintStmtOccurrence *> occurrences;
+  std::vector<Enumerator::Request> requests;
+  for (ClintStmt *stmt : statements()) {
+    for (ClintStmtOccurrence *occurrence : stmt->occurrences()) {
+      if (occurrence->hasPoints() ||
+          occurrence->boundingBoxSize(horizontalDimIdx, verticalDimIdx) > clippingThreshold)
+        continue;
+
+      Enumerator::Request request;
+      request.relation = occurrence->pointsRelation(request.dimensions);
+      requests.push_back(std::move(request));
+      occurrences.push_back(occurrence);
+    }
+  }
+  if (requests.empty())
+    return;
+
+  std::vector<PointBuffer> points = m_program->enumerator()->enumerateMany(requests);
+  for (size_t i = 0; i < occurrences.size(); ++i) {
+    occurrences[i]->prefetchPoints(std::move(points[i]));
+    osl_relation_free(requests[i].relation);
+  }
+}
+
 int ClintScop::lastValueInLoop(const std::vector<int> &loopBeta) const {
   // Assuming m_vizBetaMap has all relevant beta (transformed).
   int value = -1;
@@ -402,12 +729,109 @@ ClintScop::dependencesBetween(ClintStmtOccurrence *occ1, ClintStmtOccurrence *oc
   return std::move(result);
 }
 
+/// Generated code only depends on the sequence and is taken from the checkpoint store if
+/// available.  Otherwise it is generated in background once the scop was not transformed for
+/// codeGenerationDelay() ms, and only if code generation is enabled, i.e. the code is visible.
+void ClintScop::scheduleCodeGeneration() {
+  cancelCodeGeneration();
+  CheckpointStore *store = checkpoints();
+  const CheckpointStore::Checkpoint *checkpoint =
+      store != nullptr ? store->find(m_scopPart, m_transformationSeq, m_transformedGroups) : nullptr;
+  if (checkpoint != nullptr && checkpoint->hasCode) {
+    free(m_generatedCode);
+    m_generatedCode = strdup(checkpoint->generatedCode.c_str());
+    m_generatedHtml = checkpoint->generatedHtml;
+    m_codeStale = false;
+    emit generatedCodeChanged();
+    return;
+  }
+
+  m_codeStale = true;
+  if (m_codeGenerationEnabled)
+    m_codeGenerationTimer->start();
+}
+
+void ClintScop::cancelCodeGeneration() {
+  m_codeGenerationTimer->stop();
+  if (!m_codeGenerationPending)
+    return;
+  m_program->codeGenerationWorker()->cancel(this);
+  m_codeGenerationPending = false;
+}
+
+void ClintScop::setCodeGenerationEnabled(bool enabled) {
+  m_codeGenerationEnabled = enabled;
+  if (!enabled) {
+    m_codeGenerationTimer->stop();
+  } else if (m_codeStale && !m_codeGenerationPending) {
+    m_codeGenerationTimer->start();
+  }
+}
+
+void ClintScop::setCodeGenerationDelay(int milliseconds) {
+  m_codeGenerationTimer->setInterval(milliseconds);
+}
+
+int ClintScop::codeGenerationDelay() const {
+  return m_codeGenerationTimer->interval();
+}
+
+void ClintScop::generateCode() {
+  // A pending execution schedules the generation again once it is finished.
+  if (!m_codeStale || !m_codeGenerationEnabled || m_executionPending)
+    return;
+
+  TransformationWorker *worker = m_program != nullptr ? m_program->codeGenerationWorker() : nullptr;
+  if (worker == nullptr) {
+    updateGeneratedHtml(m_transformedScop, m_generatedHtml);
+    m_codeStale = false;
+    emit generatedCodeChanged();
+    return;
+  }
+
+  TransformationWorker::Job job;
+  job.owner = this;
+  job.original = nullptr;
+  job.base = osl_scop_clone(m_transformedScop);
+  job.firstGroup = m_transformedGroups;
+  job.groups = std::vector<TransformationGroup>(std::begin(m_transformationSeq.groups),
+                                                std::begin(m_transformationSeq.groups) + m_transformedGroups);
+  job.analyzeDependences = false;
+  m_codeGeneration = worker->submit(std::move(job));
+  m_codeGenerationPending = true;
+}
+
+void ClintScop::codeGenerated() {
+  if (!m_codeGenerationPending)
+    return;
+  TransformationWorker::Result result;
+  if (!m_program->codeGenerationWorker()->takeResult(this, m_codeGeneration, result))
+    return;
+  m_codeGenerationPending = false;
+  osl_scop_free(result.transformed);
+
+  free(m_generatedCode);
+  m_generatedCode = result.generatedCode;
+  updateGeneratedHtml(result.positions, m_generatedHtml);
+  m_codeStale = false;
+
+  CheckpointStore *store = checkpoints();
+  if (store != nullptr) {
+    store->storeCode(m_scopPart, m_transformationSeq, result.nbGroups, m_generatedCode, m_generatedHtml);
+  }
+  emit generatedCodeChanged();
+}
+
 void ClintScop::undoTransformation() {
   if (!hasUndo())
     return;
+  cancelExecution();
   m_undoneTransformationSeq.groups.push_back(m_transformationSeq.groups.back());
   m_transformationSeq.groups.erase(std::end(m_transformationSeq.groups) - 1);
   --m_groupsExecuted;
+  if (m_transformedGroups > m_transformationSeq.groups.size())
+    m_transformedScopStale = true;
+  appliedScopFlushCache();
 //  executeTransformationSequence();
 }
 
@@ -3,6 +3,7 @@
 
 #include <QObject>
 
+#include <functional>
 #include <map>
 #include <set>
 #include <sstream>
@@ -17,6 +18,7 @@
 class ClintDependence;
 class ClintStmt;
 class ClintStmtOccurrence;
+class QTimer;
 
 class ClintScop : public QObject {
   Q_OBJECT
@@ -89,6 +91,33 @@ public:
   }
 
   void executeTransformationSequence();
+  /// Execute the sequence on the transformation worker of the program and call @p completion
+  /// once the result was applied.  A newer execution supersedes this one, its completion is dropped.
+  void executeTransformationSequenceAsync(std::function<void ()> completion = std::function<void ()>());
+
+  bool isExecutionPending() const {
+    return m_executionPending;
+  }
+
+  /// Check in background whether appending @p group to the sequence violates dependences that are
+  /// not violated now.  Returns the generation reported by legalityPreviewed(), 0 if there is no
+  /// worker.  A newer preview supersedes this one.  The analysis goes through the same
+  /// DependenceAnalyzer as executions, so its Candl calls are serialized with theirs.
+  unsigned previewLegality(const TransformationGroup &group);
+  void cancelLegalityPreview();
+
+  /// Generate code in background after the scop stayed untransformed for codeGenerationDelay() ms.
+  /// Disabled code generation is deferred until it is enabled again, e.g. when the code is hidden.
+  void setCodeGenerationEnabled(bool enabled);
+  void setCodeGenerationDelay(int milliseconds);
+  int codeGenerationDelay() const;
+
+  /// Whether generatedCode() and generatedHtml() lag behind the transformation sequence.
+  bool isCodeStale() const {
+    return m_codeStale;
+  }
+
+  const static int DEFAULT_CODE_GENERATION_DELAY = 300;
 
   boost::optional<Transformation> guessInverseTransformation(const Transformation &transformation) {
     return m_transformer->guessInverseTransformation(appliedScop(), transformation);
@@ -96,6 +125,7 @@ public:
 
   ClintStmtOccurrence *occurrence(const std::vector<int> &beta) const;
   std::unordered_set<ClintStmtOccurrence *> occurrences(const std::vector<int> &betaPrefix) const;
+  void prefetchPoints(int horizontalDimIdx, int verticalDimIdx, int clippingThreshold);
   int lastValueInLoop(const std::vector<int> &loopBeta) const;
   std::unordered_set<ClintDependence *> internalDependences(ClintStmtOccurrence *occurrence) const;
   std::unordered_set<ClintDependence *> dependencesBetween(ClintStmtOccurrence *occ1, ClintStmtOccurrence *occ2) const;
@@ -169,24 +199,53 @@ public:
 signals:
   void transformExecuted();
   void dimensionalityChanged();
+  void generatedCodeChanged();
+  void legalityPreviewed(unsigned generation, bool legal);
 
 public slots:
   void undoTransformation();
   void redoTransformation();
   void clearRedo();
 
+private slots:
+  void transformationExecuted();
+  void generateCode();
+  void codeGenerated();
+  void legalityPreviewExecuted();
+
 private:
+  osl_scop_p cloneExecutionBase(size_t &firstGroup);
+  void cancelExecution();
+  void finishExecution();
+  void scheduleCodeGeneration();
+  void cancelCodeGeneration();
+  void updateScript();
+  void updateOccurrenceStructure(const Transformation &transformation);
   void updateGeneratedHtml(osl_scop_p transformedScop, std::string &string);
+  void updateGeneratedHtml(const std::multimap<std::vector<int>, std::pair<int, int>> &positions,
+                           std::string &string);
   void forwardDependencesBetween(ClintStmtOccurrence *occ1, ClintStmtOccurrence *occ2,
                                  std::unordered_set<ClintDependence *> &result) const;
-  void clearDependences();
   void processDependenceMap(const DependenceAnalyzer::DependenceMap &dependenceMap);
-  void createDependences(osl_scop_p scop);
-  void updateDependences(osl_scop_p transformed);
+  DependenceAnalyzer::DependenceMap createDependences(osl_scop_p scop);
+  DependenceAnalyzer::DependenceMap updateDependences(osl_scop_p transformed);
   void resetOccurrences(osl_scop_p transformed);
 
   void remapBetas(const TransformationGroup &tg);
 
+  CheckpointStore *checkpoints() const {
+    return m_program != nullptr ? m_program->checkpoints() : nullptr;
+  }
+
+  LegalityCache *legalityCache() const {
+    return m_program != nullptr ? m_program->legalityCache() : nullptr;
+  }
+
+  // Scop the current dependences were analyzed for.
+  osl_scop_p analyzedScop() const {
+    return m_transformedScop != nullptr ? m_transformedScop : m_scopPart;
+  }
+
   osl_scop_p m_scopPart;
   osl_scop_p m_appliedScopCache = nullptr;
   ClintProgram *m_program;
@@ -204,7 +263,27 @@ private:
   Transformer *m_scriptGenerator;
   ClayBetaMapper *m_betaMapper;
   size_t m_groupsExecuted = 0;
+  // Result of the last execution of the sequence, i.e. the first m_transformedGroups groups applied
+  // to m_scopPart.  Stale if some of these groups were removed from the sequence afterwards.
+  osl_scop_p m_transformedScop = nullptr;
+  size_t m_transformedGroups = 0;
+  bool m_transformedScopStale = false;
+  // Generation of the job submitted to the transformation worker, if any.
+  bool m_executionPending = false;
+  unsigned m_executionGeneration = 0;
+  std::function<void ()> m_executionCompletion;
+  // Generation of the legality preview job submitted last, if any.
+  bool m_previewPending = false;
+  unsigned m_previewGeneration = 0;
+  // Generated code is out of date until the code generation job submitted last, if any, is finished.
+  QTimer *m_codeGenerationTimer;
+  bool m_codeGenerationEnabled = true;
+  bool m_codeStale = false;
+  bool m_codeGenerationPending = false;
+  unsigned m_codeGeneration = 0;
   DependenceAnalyzer *m_analyzer;
+  // Result of the analysis the dependences are built from, the base of the incremental analysis.
+  DependenceAnalyzer::DependenceMap m_analyzedDependences;
 
   char *m_originalCode  = nullptr;
   char *m_generatedCode = nullptr;
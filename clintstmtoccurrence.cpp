@@ -2,7 +2,12 @@
 #include "clintstmt.h"
 #include "clintstmtoccurrence.h"
 
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
 #include <functional>
+#include <tuple>
+#include <unordered_set>
 
 ClintStmtOccurrence::ClintStmtOccurrence(osl_statement_p stmt, const std::vector<int> &betaVector,
                                      ClintStmt *parent) :
@@ -10,6 +15,10 @@ ClintStmtOccurrence::ClintStmtOccurrence(osl_statement_p stmt, const std::vector
   resetOccurrence(stmt, betaVector);
 }
 
+ClintStmtOccurrence::~ClintStmtOccurrence() {
+  osl_relation_free(m_pointsDomain);
+}
+
 /// The split occurrence will hot have osl_statement set up by default.  Use resetOccurrence to initialize it.
 ClintStmtOccurrence *ClintStmtOccurrence::split(const std::vector<int> &betaVector) {
   ClintStmtOccurrence *occurrence = new ClintStmtOccurrence(nullptr, betaVector, m_statement);
@@ -25,6 +34,9 @@ void ClintStmtOccurrence::resetOccurrence(osl_statement_p stmt, const std::vecto
   m_oslStatement = stmt;
 
   if (stmt == nullptr) {
+    m_cachedDimMins.clear();
+    m_cachedDimMaxs.clear();
+    invalidatePoints();
     if (m_oslScattering != nullptr)
       emit pointsChanged();
     if (differentBeta)
@@ -44,6 +56,13 @@ void ClintStmtOccurrence::resetOccurrence(osl_statement_p stmt, const std::vecto
                "Trying to create an occurrence for the inexistent beta-vector");
 
   differentPoints = !osl_relation_equal(oslScattering, m_oslScattering);
+  if (differentPoints) {
+    m_cachedDimMins.clear();
+    m_cachedDimMaxs.clear();
+    if (!reapplyScattering(stmt, oslScattering)) {
+      invalidatePoints();
+    }
+  }
   m_oslScattering = oslScattering;
 
   if (differentPoints) {
@@ -81,7 +100,20 @@ int ClintStmtOccurrence::ignoreTilingDim(int dim) const {
   return dim;
 }
 
-std::vector<std::vector<int>> ClintStmtOccurrence::projectOn(int horizontalDimIdx, int verticalDimIdx) const {
+/// Domain of the occurrence in the scattered space (scattered dimensions followed by
+/// the original ones) with parameters fixed to their current values.
+osl_relation_p ClintStmtOccurrence::scatteredDomain() const {
+  std::vector<osl_relation_p> scatterings { m_oslScattering };
+  osl_relation_p applied = oslApplyScattering(oslListToVector(m_oslStatement->domain),
+                                              scatterings);
+  osl_relation_p ready = oslRelationsWithContext(applied, m_statement->scop()->fixedContext());
+  osl_relation_free(applied);
+  return ready;
+}
+
+/// Indices of the scattered domain dimensions that form the projection: visible scattered
+/// dimensions, if any, followed by all original dimensions.
+std::vector<int> ClintStmtOccurrence::projectionDimensions(int horizontalDimIdx, int verticalDimIdx) const {
   if (m_oslScattering == nullptr) {
     std::cerr << "don't project" << std::endl;
   }
@@ -141,49 +173,248 @@ std::vector<std::vector<int>> ClintStmtOccurrence::projectOn(int horizontalDimId
   CLINT_ASSERT(!(projectVertical ^ (verticalScatDimIdx >= 0 && verticalScatDimIdx < m_oslScattering->nb_output_dims)),
                "Trying to project to the vertical dimension that is not present in scattering");
 
-  std::vector<osl_relation_p> scatterings { m_oslScattering };
-  osl_relation_p applied = oslApplyScattering(oslListToVector(m_oslStatement->domain),
-                                              scatterings);
-  osl_relation_p ready = oslRelationsWithContext(applied, m_statement->scop()->fixedContext());
-
-  std::vector<int> allDimensions;
-  allDimensions.reserve(m_oslScattering->nb_output_dims + 2);
+  std::vector<int> dimensions;
+  dimensions.reserve(m_oslScattering->nb_output_dims + 2);
   if (projectHorizontal && horizontalOrigDimValid) {
-    allDimensions.push_back(horizontalScatDimIdx);
+    dimensions.push_back(horizontalScatDimIdx);
   }
   if (projectVertical && verticalOrigDimValid) {
-    allDimensions.push_back(verticalScatDimIdx);
+    dimensions.push_back(verticalScatDimIdx);
   }
   for (int i = 0, e = m_oslScattering->nb_input_dims; i < e; ++i) {
-    allDimensions.push_back(m_oslScattering->nb_output_dims + i);
+    dimensions.push_back(m_oslScattering->nb_output_dims + i);
   }
-  std::vector<std::vector<int>> points = program()->enumerator()->enumerate(ready, allDimensions);
-  computeMinMax(points, horizontalDimIdx, verticalDimIdx);
+  return std::move(dimensions);
+}
+
+/// Relation and dimensions to enumerate all points of the occurrence at once.
+/// The caller is responsible for freeing the relation.
+osl_relation_p ClintStmtOccurrence::pointsRelation(std::vector<int> &dimensions) const {
+  CLINT_ASSERT(m_oslStatement != nullptr && m_oslScattering != nullptr,
+               "Trying to enumerate a non-initialized statement");
+  dimensions.clear();
+  for (int i = 0, e = m_oslScattering->nb_output_dims + m_oslScattering->nb_input_dims; i < e; ++i) {
+    dimensions.push_back(i);
+  }
+  return scatteredDomain();
+}
+
+const PointBuffer &ClintStmtOccurrence::enumeratedPoints() const {
+  if (!m_pointsValid) {
+    std::vector<int> dimensions;
+    osl_relation_p ready = pointsRelation(dimensions);
+    m_points = program()->enumerator()->enumerate(ready, dimensions);
+    osl_relation_free(ready);
+    setPointsValid();
+  }
+  return m_points;
+}
+
+/// Express each output dimension of the scattering as an affine function of its input dimensions,
+/// with parameters substituted by their values.  Coefficients are stored row-major, one row of
+/// (input dimensions + 1) values per output dimension, constant last.  Returns false if the
+/// scattering is not such a function, e.g. has inequalities, local dimensions or non-unit
+/// output coefficients.
+static bool affineScatteringCoefficients(osl_relation_p scattering, const std::vector<int> &parameterValues,
+                                         std::vector<int> &coefficients) {
+  const int nbOutput = scattering->nb_output_dims;
+  const int nbInput  = scattering->nb_input_dims;
+  if (scattering->nb_local_dims != 0 || scattering->nb_rows != nbOutput)
+    return false;
+
+  const int firstInput     = 1 + nbOutput;
+  const int firstParameter = firstInput + nbInput;
+  coefficients.assign(nbOutput * (nbInput + 1), 0);
+  std::vector<bool> defined(nbOutput, false);
+  for (int row = 0; row < scattering->nb_rows; ++row) {
+    if (!osl_int_zero(scattering->precision, scattering->m[row][0]))
+      return false;
+
+    int output = -1;
+    for (int i = 0; i < nbOutput; ++i) {
+      if (osl_int_zero(scattering->precision, scattering->m[row][1 + i]))
+        continue;
+      if (output != -1)
+        return false;
+      output = i;
+    }
+    if (output == -1 || defined[output])
+      return false;
+    int outputCoefficient = osl_int_get_si(scattering->precision, scattering->m[row][1 + output]);
+    if (outputCoefficient != 1 && outputCoefficient != -1)
+      return false;
+    defined[output] = true;
+
+    // a*o + b*i + c*p + d = 0  <=>  o = -(b*i + c*p + d) / a,  with a = +/-1.
+    int *outputRow = coefficients.data() + output * (nbInput + 1);
+    for (int i = 0; i < nbInput; ++i) {
+      outputRow[i] = -outputCoefficient * osl_int_get_si(scattering->precision, scattering->m[row][firstInput + i]);
+    }
+    int constant = osl_int_get_si(scattering->precision, scattering->m[row][scattering->nb_columns - 1]);
+    for (int i = 0; i < scattering->nb_parameters; ++i) {
+      constant += osl_int_get_si(scattering->precision, scattering->m[row][firstParameter + i]) * parameterValues[i];
+    }
+    outputRow[nbInput] = -outputCoefficient * constant;
+  }
+  return true;
+}
+
+void ClintStmtOccurrence::setPointsValid() const {
+  std::vector<int> coefficients;
+  osl_relation_free(m_pointsDomain);
+  m_pointsDomain = osl_relation_clone(m_oslStatement->domain);
+  m_pointsAffine = affineScatteringCoefficients(m_oslScattering, scop()->parameterValues(), coefficients);
+  m_pointsValid = true;
+}
+
+void ClintStmtOccurrence::invalidatePoints() {
+  m_points.clear();
+  m_pointsValid = false;
+  osl_relation_free(m_pointsDomain);
+  m_pointsDomain = nullptr;
+  m_pointsAffine = false;
+}
 
+/// Recompute the enumerated points for a new scattering of the same domain by evaluating
+/// the scattering over the original coordinates instead of enumerating again.  Returns false
+/// if this is impossible: the domain changed (e.g. after index-set splitting or collapsing),
+/// or either scattering is not an affine function (e.g. after tiling).
+bool ClintStmtOccurrence::reapplyScattering(osl_statement_p stmt, osl_relation_p scattering) {
+  if (!m_pointsValid || !m_pointsAffine)
+    return false;
+  if (!osl_relation_equal(stmt->domain, m_pointsDomain))
+    return false;
+
+  std::vector<int> coefficients;
+  if (!affineScatteringCoefficients(scattering, scop()->parameterValues(), coefficients))
+    return false;
+
+  const size_t nbInput  = scattering->nb_input_dims;
+  const size_t nbOutput = scattering->nb_output_dims;
+  const size_t oldStride = m_points.stride();
+  CLINT_ASSERT(oldStride >= nbInput, "Enumerated points do not match the scattering");
+  const size_t oldNbOutput = oldStride - nbInput;
+  const size_t nbPoints = m_points.size();
+  const size_t stride = nbOutput + nbInput;
+
+  PointBuffer points(stride);
+  points.resize(nbPoints);
+
+  // Column by column over the flat buffers: original coordinates are copied, scattered ones
+  // are dot products with the coefficients.  Inner loops have no branches and vectorize.
+  const PointBuffer::value_type *source = m_points.data() + oldNbOutput;
+  PointBuffer::value_type *target = points.data();
+  for (size_t j = 0; j < nbInput; ++j) {
+    for (size_t i = 0; i < nbPoints; ++i) {
+      target[i * stride + nbOutput + j] = source[i * oldStride + j];
+    }
+  }
+  for (size_t o = 0; o < nbOutput; ++o) {
+    const int *outputRow = coefficients.data() + o * (nbInput + 1);
+    for (size_t i = 0; i < nbPoints; ++i) {
+      target[i * stride + o] = outputRow[nbInput];
+    }
+    for (size_t j = 0; j < nbInput; ++j) {
+      const int coefficient = outputRow[j];
+      if (coefficient == 0)
+        continue;
+      for (size_t i = 0; i < nbPoints; ++i) {
+        target[i * stride + o] += coefficient * source[i * oldStride + j];
+      }
+    }
+  }
+
+  m_points = std::move(points);
+  m_pointsAffine = true;
+  return true;
+}
+
+PointBuffer ClintStmtOccurrence::projectOn(int horizontalDimIdx, int verticalDimIdx) const {
+  std::vector<int> dimensions = projectionDimensions(horizontalDimIdx, verticalDimIdx);
+  const PointBuffer &points = enumeratedPoints();
+
+  // Project in a single pass over the full buffer.  Points that coincide after projection
+  // are deduplicated by hashing; the set holds indices of the unique rows in the result.
+  PointBuffer projected(dimensions.size());
+  projected.reserve(points.size());
+  auto rowHash = [&projected](size_t idx) {
+    PointBuffer::Row row = projected[idx];
+    return boost::hash_range(row.begin(), row.end());
+  };
+  auto rowEqual = [&projected](size_t lhs, size_t rhs) {
+    PointBuffer::Row lhsRow = projected[lhs];
+    return std::equal(lhsRow.begin(), lhsRow.end(), projected[rhs].begin());
+  };
+  std::unordered_set<size_t, decltype(rowHash), decltype(rowEqual)> uniqueRows(points.size(), rowHash, rowEqual);
+  for (PointBuffer::Row point : points) {
+    PointBuffer::value_type *row = projected.appendRow();
+    for (size_t i = 0, e = dimensions.size(); i < e; ++i) {
+      row[i] = point[dimensions[i]];
+    }
+    if (!uniqueRows.insert(projected.size() - 1).second) {
+      projected.removeLast();
+    }
+  }
+  computeMinMax(projected, horizontalDimIdx, verticalDimIdx);
+
+  return std::move(projected);
+}
+
+/// Project only the points whose visible scattered coordinates are within the given
+/// (inclusive) ranges.  The ranges are added to the scattered domain as constraints so
+/// that the points outside them are never enumerated.  Unlike the unrestricted
+/// projection, this does not update the cached bounds of the occurrence.
+PointBuffer ClintStmtOccurrence::projectOn(int horizontalDimIdx, int verticalDimIdx,
+                                           std::pair<int, int> horizontalRange,
+                                           std::pair<int, int> verticalRange) const {
+  std::vector<int> dimensions = projectionDimensions(horizontalDimIdx, verticalDimIdx);
+  bool projectHorizontal = (horizontalDimIdx != -2) && (dimensionality() > horizontalDimIdx);
+  size_t nbScatteredDimensions = dimensions.size() - m_oslScattering->nb_input_dims;
+
+  osl_relation_p ready = scatteredDomain();
+  auto restrict = [&ready](int dimension, std::pair<int, int> range) {
+    osl_relation_p restricted = oslRelationsWithBounds(ready, dimension, range.first, range.second);
+    osl_relation_free(ready);
+    ready = restricted;
+  };
+  if (nbScatteredDimensions == 2) {
+    restrict(dimensions[0], horizontalRange);
+    restrict(dimensions[1], verticalRange);
+  } else if (nbScatteredDimensions == 1) {
+    restrict(dimensions[0], projectHorizontal ? horizontalRange : verticalRange);
+  }
+
+  PointBuffer points = program()->enumerator()->enumerate(ready, dimensions);
+  osl_relation_free(ready);
   return std::move(points);
 }
 
-std::pair<std::vector<int>, std::pair<int, int>> ClintStmtOccurrence::parseProjectedPoint(std::vector<int> point,
+void ClintStmtOccurrence::prefetchPoints(PointBuffer &&points) {
+  m_points = std::move(points);
+  setPointsValid();
+}
+
+std::pair<std::vector<int>, std::pair<int, int>> ClintStmtOccurrence::parseProjectedPoint(PointBuffer::Row point,
                                                                                           int horizontalDimIdx,
                                                                                           int verticalDimIdx) const {
   std::pair<int, int> scatteredCoordinates {INT_MAX, INT_MAX}; // FIXME: INT_MAX is VizPoint::NO_COORD
+  size_t first = 0;
 
   if (visibleDimensionality() >= horizontalDimIdx && horizontalDimIdx != -2) {
-    CLINT_ASSERT(point.size() > 0, "Not enough dimensions");
-    scatteredCoordinates.first = point[0];
-    point.erase(std::begin(point));
+    CLINT_ASSERT(point.size() > first, "Not enough dimensions");
+    scatteredCoordinates.first = point[first++];
   }
   if (visibleDimensionality() >= verticalDimIdx && verticalDimIdx != -2) {
-    CLINT_ASSERT(point.size() > 0, "Not enough dimensions");
-    scatteredCoordinates.second = point[0];
-    point.erase(std::begin(point));
+    CLINT_ASSERT(point.size() > first, "Not enough dimensions");
+    scatteredCoordinates.second = point[first++];
   }
 
-  return std::make_pair(point, scatteredCoordinates);
+  std::vector<int> originalCoordinates(point.begin() + first, point.end());
+  return std::make_pair(std::move(originalCoordinates), scatteredCoordinates);
 }
 
 
-void ClintStmtOccurrence::computeMinMax(const std::vector<std::vector<int>> &points,
+void ClintStmtOccurrence::computeMinMax(const PointBuffer &points,
                                       int horizontalDimIdx, int verticalDimIdx) const {
   // Initialize with extreme values for min and max unless already computed for previous polyhedron
   int horizontalMin, horizontalMax, verticalMin = 0, verticalMax = 0;
@@ -212,7 +443,7 @@ void ClintStmtOccurrence::computeMinMax(const std::vector<std::vector<int>> &poi
   }
 
   // Compute min and max values for projected iterators of the current coordinate system.
-  for (const std::vector<int> &point : points) {
+  for (PointBuffer::Row point : points) {
     if (computeHorizontal) {
       horizontalMin = std::min(horizontalMin, point[0]);
       horizontalMax = std::max(horizontalMax, point[0]);
@@ -237,6 +468,46 @@ void ClintStmtOccurrence::computeMinMax(const std::vector<std::vector<int>> &poi
   }
 }
 
+void ClintStmtOccurrence::computeBounds() const {
+  CLINT_ASSERT(m_oslStatement != nullptr && m_oslScattering != nullptr,
+               "Trying to compute bounds of a non-initialized statement");
+
+  std::vector<int> visibleDimensions, scatteredDimensions;
+  for (int i = 0, e = dimensionality(); i < e; ++i) {
+    int scatDimIdx = ignoreTilingDim(1 + 2 * i);
+    if (scatDimIdx < m_oslScattering->nb_output_dims) {
+      visibleDimensions.push_back(i);
+      scatteredDimensions.push_back(scatDimIdx);
+    } else {
+      m_cachedDimMins[i] = 0;
+      m_cachedDimMaxs[i] = 0;
+    }
+  }
+
+  // Bounds are computed in closed form on the scattered domain, no points are enumerated.
+  osl_relation_p ready = scatteredDomain();
+  std::vector<std::pair<int, int>> bounds = program()->enumerator()->bounds(ready, scatteredDimensions);
+  osl_relation_free(ready);
+
+  for (size_t i = 0; i < visibleDimensions.size(); ++i) {
+    m_cachedDimMins[visibleDimensions[i]] = bounds[i].first;
+    m_cachedDimMaxs[visibleDimensions[i]] = bounds[i].second;
+  }
+}
+
+std::pair<std::pair<int, int>, std::pair<int, int>>
+ClintStmtOccurrence::boundingBox(int horizontalDimIdx, int verticalDimIdx) const {
+  return std::make_pair(std::make_pair(minimumValue(horizontalDimIdx), maximumValue(horizontalDimIdx)),
+                        std::make_pair(minimumValue(verticalDimIdx), maximumValue(verticalDimIdx)));
+}
+
+long long ClintStmtOccurrence::boundingBoxSize(int horizontalDimIdx, int verticalDimIdx) const {
+  std::pair<int, int> horizontalBounds, verticalBounds;
+  std::tie(horizontalBounds, verticalBounds) = boundingBox(horizontalDimIdx, verticalDimIdx);
+  return static_cast<long long>(horizontalBounds.second - horizontalBounds.first + 1) *
+      static_cast<long long>(verticalBounds.second - verticalBounds.first + 1);
+}
+
 std::vector<int> ClintStmtOccurrence::makeBoundlikeForm(Bound bound, int dimIdx, int constValue,
                                                         int constantBoundaryPart,
                                                         const std::vector<int> &parameters,
@@ -361,7 +632,7 @@ int ClintStmtOccurrence::minimumValue(int dimIdx) const {
   if (dimIdx >= dimensionality() || dimIdx < 0)
     return 0;
   if (m_cachedDimMins.count(dimIdx) == 0) {
-    projectOn(dimIdx, -2); // FIXME: -2 is VizProperties::NoDimension
+    computeBounds();
   }
   CLINT_ASSERT(m_cachedDimMins.count(dimIdx) == 1,
                "min cache failure");
@@ -372,7 +643,7 @@ int ClintStmtOccurrence::maximumValue(int dimIdx) const {
   if (dimIdx >= dimensionality() || dimIdx < 0)
     return 0;
   if (m_cachedDimMaxs.count(dimIdx) == 0) {
-    projectOn(dimIdx, -2); // FIXME: -2 is VizProperties::NoDimension
+    computeBounds();
   }
   CLINT_ASSERT(m_cachedDimMaxs.count(dimIdx) == 1,
                "max cache failure");
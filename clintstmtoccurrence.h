@@ -2,6 +2,7 @@
 #define CLINTSTMTOCCURRENCE_H
 
 #include "clintstmt.h"
+#include "pointbuffer.h"
 
 #include <osl/relation.h>
 #include <osl/statement.h>
@@ -9,7 +10,9 @@
 #include <QObject>
 
 #include <initializer_list>
+#include <map>
 #include <set>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
@@ -19,6 +22,7 @@ public:
   ClintStmtOccurrence(osl_statement_p stmt,
                     const std::vector<int> &betaVector,
                     ClintStmt *parent = 0);
+  ~ClintStmtOccurrence();
 
   ClintStmtOccurrence *split(const std::vector<int> &betaVector);
 
@@ -26,8 +30,15 @@ public:
   friend bool operator ==(const ClintStmtOccurrence &lhs, const ClintStmtOccurrence &rhs);
 
   int ignoreTilingDim(int dimension) const;
-  std::vector<std::vector<int>> projectOn(int horizontalDimIdx, int verticalDimIdx) const;
-  std::pair<std::vector<int>, std::pair<int, int>> parseProjectedPoint(std::vector<int> point,
+  PointBuffer projectOn(int horizontalDimIdx, int verticalDimIdx) const;
+  PointBuffer projectOn(int horizontalDimIdx, int verticalDimIdx,
+                        std::pair<int, int> horizontalRange, std::pair<int, int> verticalRange) const;
+  osl_relation_p pointsRelation(std::vector<int> &dimensions) const;
+  void prefetchPoints(PointBuffer &&points);
+  bool hasPoints() const {
+    return m_pointsValid;
+  }
+  std::pair<std::vector<int>, std::pair<int, int>> parseProjectedPoint(PointBuffer::Row point,
                                                                        int horizontalDimIdx, int verticalDimIdx) const;
 
   int dimensionality() const {
@@ -129,6 +140,10 @@ public:
 
   int minimumValue(int dimIdx) const;
   int maximumValue(int dimIdx) const;
+  /// Bounding box of the occurrence projection as ((horizontal min, max), (vertical min, max)).
+  std::pair<std::pair<int, int>, std::pair<int, int>> boundingBox(int horizontalDimIdx, int verticalDimIdx) const;
+  /// Number of integer positions in the bounding box of the occurrence projection.
+  long long boundingBoxSize(int horizontalDimIdx, int verticalDimIdx) const;
 
   void resetOccurrence(osl_statement_p stmt, const std::vector<int> &betaVector);
   void resetBetaVector(const std::vector<int> &betaVector);
@@ -172,8 +187,26 @@ private:
   mutable std::unordered_map<int, int> m_cachedDimMins;
   mutable std::unordered_map<int, int> m_cachedDimMaxs;
 
-  void computeMinMax(const std::vector<std::vector<int>> &points,
+  // All points of the occurrence in the scattered space, scattered dimensions followed by the
+  // original ones.  Enumerated once, every projection is derived from this buffer.
+  mutable PointBuffer m_points;
+  mutable bool m_pointsValid = false;
+  // Domain the points were enumerated for and whether the scattering they were enumerated
+  // with is an affine function of the original iterators.  If both hold for the new
+  // scattering, its values are computed from the original coordinates without enumeration.
+  mutable osl_relation_p m_pointsDomain = nullptr;
+  mutable bool m_pointsAffine = false;
+
+  void setPointsValid() const;
+  void invalidatePoints();
+  bool reapplyScattering(osl_statement_p stmt, osl_relation_p scattering);
+
+  void computeMinMax(const PointBuffer &points,
                      int horizontalDimIdx, int verticalDimIdx) const;
+  void computeBounds() const;
+  osl_relation_p scatteredDomain() const;
+  const PointBuffer &enumeratedPoints() const;
+  std::vector<int> projectionDimensions(int horizontalDimIdx, int verticalDimIdx) const;
   std::vector<int> makeBoundlikeForm(Bound bound, int dimIdx, int constValue, int constantBoundaryPart, const std::vector<int> &parameters, const std::vector<int> &parameterValues);
 };
 
@@ -66,6 +66,8 @@ ClintWindow::ClintWindow(QWidget *parent) :
   m_codeEditor = new QTextEdit;
   m_codeEditor->setFont(monospacefont);
   m_scriptEditor->setFont(monospacefont);
+  // Code is only generated while it can be seen.
+  m_codeEditor->installEventFilter(this);
 
   m_reparseCodeButton = new QPushButton("<");
   m_reparseScriptButton = new QPushButton("<");
@@ -180,8 +182,10 @@ void ClintWindow::fileClose() {
 
   if (m_program) {
     ClintScop *vscop = (*m_program)[0];
-    if (vscop)
+    if (vscop) {
       disconnect(vscop, &ClintScop::transformExecuted, this, &ClintWindow::scopTransformed);
+      disconnect(vscop, &ClintScop::generatedCodeChanged, this, &ClintWindow::updateCodeEditor);
+    }
   }
   m_fileBasename = QString();
 
@@ -283,6 +287,8 @@ void ClintWindow::openFileByName(QString fileName) {
   m_program = new ClintProgram(scop, originalCode, this);
   ClintScop *vscop = (*m_program)[0];
   connect(vscop, &ClintScop::transformExecuted, this, &ClintWindow::scopTransformed);
+  connect(vscop, &ClintScop::generatedCodeChanged, this, &ClintWindow::updateCodeEditor);
+  updateCodeGeneration();
 
   createProjections(vscop);
 
@@ -303,6 +309,8 @@ ClintScop *ClintWindow::regenerateScopWithSequence(osl_scop_p originalScop, cons
 
   ClintScop *newscop = new ClintScop(originalScop, m_parameterValue, nullptr, m_program); // FIXME: provide original code when coloring is done for it...
   (*m_program)[0] = newscop;
+  connect(newscop, &ClintScop::generatedCodeChanged, this, &ClintWindow::updateCodeEditor);
+  updateCodeGeneration();
 
   createProjections(newscop);
 
@@ -314,6 +322,7 @@ ClintScop *ClintWindow::regenerateScopWithSequence(osl_scop_p originalScop, cons
     newscop->executeTransformationSequence();
     connect(newscop, &ClintScop::transformExecuted, this, &ClintWindow::scopTransformed);
     disconnect(oldscop, &ClintScop::transformExecuted, this, &ClintWindow::scopTransformed);
+    disconnect(oldscop, &ClintScop::generatedCodeChanged, this, &ClintWindow::updateCodeEditor);
     return newscop;
   } catch (std::logic_error e) {
     QMessageBox::critical(this, "Could not apply sequence", e.what(), QMessageBox::Ok, QMessageBox::Ok);
@@ -329,6 +338,10 @@ void ClintWindow::regenerateScop(osl_scop_p originalScop) {
   if (originalScop == nullptr) {
     CLINT_ASSERT(oldscop != nullptr, "regenerating scop with no original provided or existing");
     originalScop = oldscop->scopPart();
+  } else if (originalScop != oldscop->scopPart()) {
+    // Snapshots and analysis results of the replaced scop cannot be reused anymore.
+    m_program->checkpoints()->remove(oldscop->scopPart());
+    m_program->legalityCache()->remove(oldscop->scopPart());
   }
   ClintScop *newscop = regenerateScopWithSequence(originalScop, oldscop->transformationSequence());
   if (newscop == NULL)
@@ -402,9 +415,27 @@ void ClintWindow::editVizProperties() {
 
 void ClintWindow::viewFreezeToggled(bool value) {
   m_showOriginalCode = value;
+  updateCodeGeneration();
   scopTransformed();
 }
 
+void ClintWindow::updateCodeGeneration() {
+  if (!m_program)
+    return;
+  ClintScop *vscop = (*m_program)[0];
+  if (!vscop)
+    return;
+  vscop->setCodeGenerationEnabled(!m_showOriginalCode && m_codeEditor->isVisible());
+}
+
+bool ClintWindow::eventFilter(QObject *watched, QEvent *event) {
+  if (watched == m_codeEditor &&
+      (event->type() == QEvent::Show || event->type() == QEvent::Hide)) {
+    updateCodeGeneration();
+  }
+  return QMainWindow::eventFilter(watched, event);
+}
+
 void ClintWindow::viewProjectionMatrixToggled(bool value) {
   if (!m_actionViewProjectionMatrix->isEnabled())
     return;
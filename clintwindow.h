@@ -23,6 +23,8 @@ public:
   void createProjections(ClintScop *vscop);
   void paintTogether(QPainter *painter, QSvgGenerator *generator);
 
+  bool eventFilter(QObject *watched, QEvent *event) override;
+
 signals:
 
 public slots:
@@ -83,6 +85,7 @@ private:
   void setupActions();
   void setupMenus();
 
+  void updateCodeGeneration();
   void resetCentralWidget(QWidget *interface = nullptr);
   ClintScop *regenerateScopWithSequence(osl_scop_p originalScop, const TransformationSequence &sequence);
   void deleteProjectionOverview();
@@ -0,0 +1,305 @@
+#include "codegenerator.h"
+#include "clastprinter.h"
+#include "enumerator.h"
+#include "macros.h"
+#include "oslutils.h"
+
+#include <isl/ast.h>
+#include <isl/ast_build.h>
+#include <isl/id.h>
+#include <isl/printer.h>
+#include <isl/union_map.h>
+#include <isl/val.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+static std::atomic<CodeGenerator::Backend> s_backend(CodeGenerator::Backend::CLooG);
+
+CodeGenerator *CodeGenerator::create(Backend backend) {
+  switch (backend) {
+  case Backend::CLooG:
+    return new CLooGCodeGenerator;
+  case Backend::ISL:
+    return new ISLCodeGenerator;
+  }
+  CLINT_UNREACHABLE;
+}
+
+CodeGenerator::Backend CodeGenerator::backend() {
+  return s_backend.load();
+}
+
+void CodeGenerator::setBackend(Backend backend) {
+  s_backend.store(backend);
+}
+
+const char *CodeGenerator::backendName(Backend backend) {
+  switch (backend) {
+  case Backend::CLooG:
+    return "cloog";
+  case Backend::ISL:
+    return "isl";
+  }
+  CLINT_UNREACHABLE;
+}
+
+char *CLooGCodeGenerator::generate(osl_scop_p scop, PositionMap &positions) {
+  std::vector<std::vector<int>> betas;
+  osl_scop_p reified = oslReifyBetas(scop, betas);
+  std::vector<osl_statement_p> statements = oslListToVector(reified->statement);
+
+  CloogState *state = cloog_state_malloc();
+  CloogOptions *options = cloog_options_malloc(state);
+  options->openscop = 1;
+  options->quiet = 1;
+
+  // Build the CLooG input directly from the scop instead of printing and parsing it.
+  CloogInput *input = cloog_input_from_osl_scop(state, reified);
+  CloogProgram *program = cloog_program_alloc(input->context, input->ud, options);
+  free(input);  // The program took over the context and the domains.
+
+  program = cloog_program_generate(program, options);
+  struct clast_stmt *root = cloog_clast_create(program, options);
+  ClastPrinter printer(statements, betas);
+  std::string code = printer.print(root, positions);
+
+  cloog_clast_free(root);
+  cloog_program_free(program);
+  cloog_options_free(options);
+  cloog_state_free(state);
+  osl_scop_free(reified);
+
+  return strdup(code.c_str());
+}
+
+namespace {
+
+// Takes the expression.
+std::string expressionCode(__isl_take isl_ast_expr *expr) {
+  isl_printer *printer = isl_printer_to_str(isl_ast_expr_get_ctx(expr));
+  printer = isl_printer_set_output_format(printer, ISL_FORMAT_C);
+  printer = isl_printer_print_ast_expr(printer, expr);
+  char *str = isl_printer_get_str(printer);
+  std::string code(str);
+  free(str);
+  isl_printer_free(printer);
+  isl_ast_expr_free(expr);
+  return std::move(code);
+}
+
+// Expressions that can be substituted into a statement body without parentheses.
+bool isAtomic(__isl_keep isl_ast_expr *expr) {
+  if (isl_ast_expr_get_type(expr) == isl_ast_expr_id)
+    return true;
+  if (isl_ast_expr_get_type(expr) != isl_ast_expr_int)
+    return false;
+  isl_val *value = isl_ast_expr_get_val(expr);
+  bool nonNegative = isl_val_is_nonneg(value) == isl_bool_true;
+  isl_val_free(value);
+  return nonNegative;
+}
+
+class ISLASTPrinter {
+public:
+  ISLASTPrinter(const std::vector<osl_statement_p> &statements,
+                const std::vector<std::vector<int>> &betas,
+                CodeGenerator::PositionMap &positions) :
+    m_statements(statements), m_betas(betas), m_positions(positions) {
+  }
+
+  std::string print(__isl_keep isl_ast_node *root) {
+    m_code.clear();
+    printNode(root, 0);
+    return std::move(m_code);
+  }
+
+private:
+  void printIndent(int indent) {
+    m_code.append(2 * indent, ' ');
+  }
+
+  void printNode(__isl_keep isl_ast_node *node, int indent);
+  void printFor(__isl_keep isl_ast_node *node, int indent);
+  void printIf(__isl_keep isl_ast_node *node, int indent);
+  void printUser(__isl_keep isl_ast_node *node, int indent);
+
+  const std::vector<osl_statement_p> &m_statements;
+  const std::vector<std::vector<int>> &m_betas;
+  CodeGenerator::PositionMap &m_positions;
+  std::string m_code;
+};
+
+void ISLASTPrinter::printNode(__isl_keep isl_ast_node *node, int indent) {
+  switch (isl_ast_node_get_type(node)) {
+  case isl_ast_node_block:
+  {
+    isl_ast_node_list *children = isl_ast_node_block_get_children(node);
+    int nbChildren = isl_ast_node_list_n_ast_node(children);
+    for (int i = 0; i < nbChildren; i++) {
+      isl_ast_node *child = isl_ast_node_list_get_ast_node(children, i);
+      printNode(child, indent);
+      isl_ast_node_free(child);
+    }
+    isl_ast_node_list_free(children);
+    break;
+  }
+  case isl_ast_node_for:
+    printFor(node, indent);
+    break;
+  case isl_ast_node_if:
+    printIf(node, indent);
+    break;
+  case isl_ast_node_user:
+    printUser(node, indent);
+    break;
+  case isl_ast_node_mark:
+  {
+    isl_ast_node *child = isl_ast_node_mark_get_node(node);
+    printNode(child, indent);
+    isl_ast_node_free(child);
+    break;
+  }
+  default:
+    CLINT_UNREACHABLE;
+  }
+}
+
+void ISLASTPrinter::printFor(__isl_keep isl_ast_node *node, int indent) {
+  std::string iterator = expressionCode(isl_ast_node_for_get_iterator(node));
+  std::string init = expressionCode(isl_ast_node_for_get_init(node));
+  isl_ast_node *body = isl_ast_node_for_get_body(node);
+
+  printIndent(indent);
+  if (isl_ast_node_for_is_degenerate(node) == isl_bool_true) {
+    // Single iteration, assign the iterator like CLooG does.
+    m_code += iterator + " = " + init + ";\n";
+    printNode(body, indent);
+    isl_ast_node_free(body);
+    return;
+  }
+
+  isl_ast_expr *incExpr = isl_ast_node_for_get_inc(node);
+  isl_val *inc = isl_ast_expr_get_val(incExpr);
+  long stride = isl_val_get_num_si(inc);
+  isl_val_free(inc);
+  isl_ast_expr_free(incExpr);
+
+  m_code += "for (" + iterator + "=" + init + ";";
+  m_code += expressionCode(isl_ast_node_for_get_cond(node)) + ";";
+  m_code += stride == 1 ? iterator + "++" : iterator + "+=" + std::to_string(stride);
+  m_code += ") {\n";
+  printNode(body, indent + 1);
+  printIndent(indent);
+  m_code += "}\n";
+  isl_ast_node_free(body);
+}
+
+void ISLASTPrinter::printIf(__isl_keep isl_ast_node *node, int indent) {
+  printIndent(indent);
+  m_code += "if (" + expressionCode(isl_ast_node_if_get_cond(node)) + ") {\n";
+  isl_ast_node *thenNode = isl_ast_node_if_get_then(node);
+  printNode(thenNode, indent + 1);
+  isl_ast_node_free(thenNode);
+  if (isl_ast_node_if_has_else(node) == isl_bool_true) {
+    printIndent(indent);
+    m_code += "} else {\n";
+    isl_ast_node *elseNode = isl_ast_node_if_get_else(node);
+    printNode(elseNode, indent + 1);
+    isl_ast_node_free(elseNode);
+  }
+  printIndent(indent);
+  m_code += "}\n";
+}
+
+void ISLASTPrinter::printUser(__isl_keep isl_ast_node *node, int indent) {
+  isl_ast_expr *call = isl_ast_node_user_get_expr(node);
+  isl_ast_expr *function = isl_ast_expr_get_op_arg(call, 0);
+  isl_id *id = isl_ast_expr_get_id(function);
+  size_t index = reinterpret_cast<uintptr_t>(isl_id_get_user(id));
+  isl_id_free(id);
+  isl_ast_expr_free(function);
+  CLINT_ASSERT(index < m_statements.size(), "AST statement does not correspond to any OpenScop statement");
+
+  // Call arguments are the values of the original iterators.
+  std::vector<std::string> substitutions;
+  int nbArguments = isl_ast_expr_get_op_n_arg(call);
+  for (int i = 1; i < nbArguments; i++) {
+    isl_ast_expr *argument = isl_ast_expr_get_op_arg(call, i);
+    bool atomic = isAtomic(argument);
+    std::string code = expressionCode(argument);
+    substitutions.push_back(atomic ? code : "(" + code + ")");
+  }
+  isl_ast_expr_free(call);
+
+  printIndent(indent);
+  int start = m_code.size();
+  m_code += oslStatementCode(m_statements[index], index + 1, substitutions);
+  m_positions.emplace(m_betas[index], std::make_pair(start, static_cast<int>(m_code.size())));
+  m_code += "\n";
+}
+
+} // end anonymous namespace
+
+char *ISLCodeGenerator::generate(osl_scop_p scop, PositionMap &positions) {
+  std::vector<std::vector<int>> betas;
+  osl_scop_p reified = oslReifyBetas(scop, betas);
+  std::vector<osl_statement_p> statements = oslListToVector(reified->statement);
+  if (statements.empty()) {
+    osl_scop_free(reified);
+    return strdup("");
+  }
+  isl_ctx *ctx = ISLEnumerator::context();
+
+  // Parameters are matched by name when domains and schedules are combined.
+  std::vector<std::string> parameters = oslParameterNames(reified);
+  isl_set *context = isl_set_params(ISLEnumerator::setFromOSLRelation(reified->context, parameters));
+
+  int nbScheduleDims = 0;
+  for (osl_statement_p stmt : statements) {
+    nbScheduleDims = std::max(nbScheduleDims, stmt->scattering->nb_output_dims);
+  }
+
+  isl_union_map *schedule = isl_union_map_empty(isl_set_get_space(context));
+  for (size_t i = 0; i < statements.size(); i++) {
+    // The statement index is stored in the identifier to be recovered from the AST.
+    std::string name = "S" + std::to_string(i + 1);
+    isl_id *id = isl_id_alloc(ctx, name.c_str(), reinterpret_cast<void *>(static_cast<uintptr_t>(i)));
+
+    isl_set *domain = ISLEnumerator::setFromOSLRelation(statements[i]->domain, parameters);
+    isl_map *scattering = ISLEnumerator::mapFromOSLRelation(statements[i]->scattering, parameters);
+    domain = isl_set_set_tuple_id(domain, isl_id_copy(id));
+    scattering = isl_map_set_tuple_id(scattering, isl_dim_in, id);
+
+    int nbDims = isl_map_dim(scattering, isl_dim_out);
+    scattering = isl_map_add_dims(scattering, isl_dim_out, nbScheduleDims - nbDims);
+    for (int d = nbDims; d < nbScheduleDims; d++) {
+      scattering = isl_map_fix_si(scattering, isl_dim_out, d, 0);
+    }
+    scattering = isl_map_intersect_domain(scattering, domain);
+    schedule = isl_union_map_add_map(schedule, scattering);
+  }
+
+  isl_ast_build *build = isl_ast_build_from_context(context);
+  isl_id_list *iterators = isl_id_list_alloc(ctx, nbScheduleDims);
+  for (int d = 0; d < nbScheduleDims; d++) {
+    std::string name = "c" + std::to_string(d + 1);
+    iterators = isl_id_list_add(iterators, isl_id_alloc(ctx, name.c_str(), nullptr));
+  }
+  build = isl_ast_build_set_iterators(build, iterators);
+  isl_ast_node *root = isl_ast_build_node_from_schedule_map(build, schedule);
+  isl_ast_build_free(build);
+
+  std::string code;
+  if (root != nullptr) {
+    ISLASTPrinter printer(statements, betas, positions);
+    code = printer.print(root);
+    isl_ast_node_free(root);
+  }
+  osl_scop_free(reified);
+
+  return strdup(code.c_str());
+}
@@ -0,0 +1,60 @@
+#ifndef CODEGENERATOR_H
+#define CODEGENERATOR_H
+
+#include <osl/osl.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Generates C code for a scop and reports where each statement occurrence is printed.
+ *
+ * Positions are character ranges [first, second) in the returned code, keyed by the beta-vector
+ * of the occurrence.  Generators keep no state between calls, so they can be created in any
+ * thread.  The backend used by oslToCCode is selected at runtime with setBackend().
+ */
+class CodeGenerator {
+public:
+  enum class Backend {
+    CLooG,
+    ISL
+  };
+
+  typedef std::multimap<std::vector<int>, std::pair<int, int>> PositionMap;
+
+  /**
+   * @brief Generate code for @p scop.
+   * @param [in]  scop      Scop with the scattering relations to follow.
+   * @param [out] positions Receives the positions of all printed statements.
+   * @return The code allocated with malloc, to be freed by the caller.
+   */
+  virtual char *generate(osl_scop_p scop, PositionMap &positions) = 0;
+  virtual ~CodeGenerator() {}
+
+  static CodeGenerator *create(Backend backend);
+
+  /// Backend used by oslToCCode.  CLooG unless changed.
+  static Backend backend();
+  static void setBackend(Backend backend);
+
+  static const char *backendName(Backend backend);
+};
+
+class CLooGCodeGenerator : public CodeGenerator {
+public:
+  char *generate(osl_scop_p scop, PositionMap &positions) override;
+};
+
+/**
+ * @brief Code generator based on the isl AST builder.
+ * Domains and schedules are converted with ISLEnumerator in the ISL context of the calling
+ * thread.  Schedules of different dimensionality are padded with zeros.
+ */
+class ISLCodeGenerator : public CodeGenerator {
+public:
+  char *generate(osl_scop_p scop, PositionMap &positions) override;
+};
+
+#endif // CODEGENERATOR_H
@@ -1,15 +1,59 @@
 #include "dependenceanalyzer.h"
+#include "enumerator.h"
 #include "macros.h"
 #include "oslutils.h"
 
+#include <isl/flow.h>
+#include <isl/id.h>
+#include <isl/map.h>
+#include <isl/set.h>
+#include <isl/union_map.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <unordered_set>
 
+static std::atomic<DependenceAnalyzer::Backend> s_backend(DependenceAnalyzer::Backend::Candl);
+
+// PipLib, used by Candl to solve its systems, keeps its working storage in global variables.
+static std::mutex s_candlMutex;
+
 DependenceAnalyzer::DependenceAnalyzer() {
 }
 
 DependenceAnalyzer::~DependenceAnalyzer() {
 }
 
+DependenceAnalyzer *DependenceAnalyzer::create(Backend backend) {
+  switch (backend) {
+  case Backend::Candl:
+    return new CandlAnalyzer;
+  case Backend::ISL:
+    return new ISLFlowAnalyzer;
+  }
+  CLINT_UNREACHABLE;
+}
+
+DependenceAnalyzer::Backend DependenceAnalyzer::backend() {
+  return s_backend.load();
+}
+
+void DependenceAnalyzer::setBackend(Backend backend) {
+  s_backend.store(backend);
+}
+
+const char *DependenceAnalyzer::backendName(Backend backend) {
+  switch (backend) {
+  case Backend::Candl:
+    return "candl";
+  case Backend::ISL:
+    return "isl";
+  }
+  CLINT_UNREACHABLE;
+}
+
 CandlAnalyzer::CandlAnalyzer() {
 }
 
@@ -18,6 +62,7 @@ CandlAnalyzer::~CandlAnalyzer() {
 
 
 osl_dependence_p CandlAnalyzer::scopDependences(osl_scop_p scop) {
+  std::lock_guard<std::mutex> lock(s_candlMutex);
   candl_scop_usr_init(scop);
   osl_dependence_p dependences = candl_dependence(scop, m_candlOptions);
   if (dependences)
@@ -27,6 +72,7 @@ osl_dependence_p CandlAnalyzer::scopDependences(osl_scop_p scop) {
 }
 
 std::pair<candl_violation_p, osl_dependence_p> CandlAnalyzer::scopViolations(osl_scop_p original, osl_scop_p transformed) {
+  std::lock_guard<std::mutex> lock(s_candlMutex);
   osl_dependence_p dependences;
   candl_violation_p violations = candl_violation(original, transformed, &dependences, m_candlOptions);
   return std::make_pair(violations, dependences);
@@ -72,3 +118,298 @@ DependenceAnalyzer::DependenceMap CandlAnalyzer::analyze(osl_scop_p original, os
 
   return dependenceMap;
 }
+
+namespace {
+
+// Scattering of an occurrence padded with zeros to nbDims, its domain identified by @p id.
+__isl_give isl_map *scheduleMap(osl_relation_p scattering, __isl_keep isl_id *id, int nbDims,
+                                const std::vector<std::string> &parameters) {
+  isl_map *schedule = ISLEnumerator::mapFromOSLRelation(scattering, parameters);
+  int nbScatteringDims = isl_map_dim(schedule, isl_dim_out);
+  schedule = isl_map_add_dims(schedule, isl_dim_out, nbDims - nbScatteringDims);
+  for (int d = nbScatteringDims; d < nbDims; d++) {
+    schedule = isl_map_fix_si(schedule, isl_dim_out, d, 0);
+  }
+  return isl_map_set_tuple_id(schedule, isl_dim_in, isl_id_copy(id));
+}
+
+// The first output dimension of an OpenScop access is the array identifier, it becomes the tuple name.
+__isl_give isl_map *accessMap(osl_relation_p access, __isl_keep isl_id *id,
+                              const std::vector<std::string> &parameters) {
+  std::string array = "A" + std::to_string(osl_relation_get_array_id(access));
+  isl_map *map = ISLEnumerator::mapFromOSLRelation(access, parameters);
+  map = isl_map_project_out(map, isl_dim_out, 0, 1);
+  map = isl_map_set_tuple_name(map, isl_dim_out, array.c_str());
+  return isl_map_set_tuple_id(map, isl_dim_in, isl_id_copy(id));
+}
+
+int scheduleDims(const std::vector<osl_statement_p> &statements) {
+  int nbDims = 0;
+  for (osl_statement_p stmt : statements) {
+    oslListForeachSingle(stmt->scattering, [&nbDims](osl_relation_p scattering) {
+      nbDims = std::max(nbDims, scattering->nb_output_dims);
+    });
+  }
+  return nbDims;
+}
+
+size_t occurrenceIndex(__isl_take isl_id *id) {
+  size_t index = reinterpret_cast<uintptr_t>(isl_id_get_user(id));
+  isl_id_free(id);
+  return index;
+}
+
+isl_stat collectBasicMap(__isl_take isl_basic_map *bmap, void *user) {
+  static_cast<std::vector<isl_basic_map *> *>(user)->push_back(bmap);
+  return isl_stat_ok;
+}
+
+isl_stat collectMapParts(__isl_take isl_map *map, void *user) {
+  isl_map_foreach_basic_map(map, &collectBasicMap, user);
+  isl_map_free(map);
+  return isl_stat_ok;
+}
+
+// Memory-based dependences: without must-sources, no source is killed.
+__isl_give isl_union_map *memoryDependences(__isl_take isl_union_map *sinks,
+                                            __isl_take isl_union_map *sources,
+                                            __isl_keep isl_union_map *schedule) {
+  isl_union_access_info *info = isl_union_access_info_from_sink(sinks);
+  info = isl_union_access_info_set_may_source(info, sources);
+  info = isl_union_access_info_set_schedule_map(info, isl_union_map_copy(schedule));
+  isl_union_flow *flow = isl_union_access_info_compute_flow(info);
+  isl_union_map *dependences = isl_union_flow_get_may_dependence(flow);
+  isl_union_flow_free(flow);
+  return dependences;
+}
+
+// A dependence is violated if some target instance is not scheduled strictly after its source.
+bool isViolated(__isl_keep isl_map *dependence,
+                __isl_keep isl_map *sourceSchedule, __isl_keep isl_map *targetSchedule) {
+  isl_map *dates = isl_map_reverse(isl_map_copy(sourceSchedule));
+  dates = isl_map_apply_range(dates, isl_map_copy(dependence));
+  dates = isl_map_apply_range(dates, isl_map_copy(targetSchedule));
+  isl_map *notAfter = isl_map_lex_ge(isl_space_range(isl_map_get_space(dates)));
+  dates = isl_map_intersect(dates, notAfter);
+  bool violated = isl_map_is_empty(dates) != isl_bool_true;
+  isl_map_free(dates);
+  return violated;
+}
+
+// The domain of an osl dependence has the source dimensions as outputs and the target ones as inputs.
+osl_dependence_p oslDependence(__isl_keep isl_basic_map *bmap, int type, int sourceLabel, int targetLabel) {
+  isl_map *reversed = isl_map_reverse(isl_map_from_basic_map(isl_basic_map_copy(bmap)));
+  osl_relation_p domain = ISLEnumerator::mapToOSLRelation(reversed);
+  isl_map_free(reversed);
+  CLINT_ASSERT(domain->next == nullptr, "Basic map converted to a union");
+
+  osl_dependence_p dependence = osl_dependence_malloc();
+  dependence->type = type;
+  dependence->label_source = sourceLabel;
+  dependence->label_target = targetLabel;
+  dependence->domain = domain;
+  dependence->source_nb_output_dims_domain = domain->nb_output_dims;
+  dependence->source_nb_output_dims_access = 0;
+  dependence->target_nb_output_dims_domain = domain->nb_input_dims;
+  dependence->target_nb_output_dims_access = 0;
+  dependence->source_nb_local_dims_domain = domain->nb_local_dims;
+  return dependence;
+}
+
+// Relation between the source and the target iterations of an osl dependence, Candl ones included.
+// Dimensions of the dependence domain are [source domain, source access, target domain, target access].
+__isl_give isl_map *dependenceRelation(osl_dependence_p dependence, __isl_keep isl_id *sourceId,
+                                       __isl_keep isl_id *targetId, const std::vector<std::string> &parameters) {
+  osl_relation_p domain = osl_relation_nclone(dependence->domain, 1);
+  domain->nb_output_dims += domain->nb_input_dims;
+  domain->nb_input_dims = 0;
+  isl_map *map = isl_map_from_range(ISLEnumerator::setFromOSLRelation(domain, parameters));
+  osl_relation_free(domain);
+
+  int nbSourceColumns = dependence->source_nb_output_dims_domain + dependence->source_nb_output_dims_access;
+  map = isl_map_move_dims(map, isl_dim_in, 0, isl_dim_out, 0, nbSourceColumns);
+  map = isl_map_project_out(map, isl_dim_in, dependence->source_nb_output_dims_domain,
+                            dependence->source_nb_output_dims_access);
+  map = isl_map_project_out(map, isl_dim_out, dependence->target_nb_output_dims_domain,
+                            dependence->target_nb_output_dims_access);
+  map = isl_map_set_tuple_id(map, isl_dim_in, isl_id_copy(sourceId));
+  return isl_map_set_tuple_id(map, isl_dim_out, isl_id_copy(targetId));
+}
+
+struct Occurrence {
+  size_t statement;
+  std::vector<int> beta;
+  isl_id *id;
+};
+
+} // end anonymous namespace
+
+DependenceAnalyzer::DependenceMap DependenceAnalyzer::reanalyze(osl_scop_p original, osl_scop_p transformed,
+                                                                osl_scop_p analyzed,
+                                                                const DependenceMap &analyzedDependences) {
+  std::vector<osl_statement_p> originalStatements = oslListToVector(original->statement);
+  std::vector<osl_statement_p> transformedStatements = oslListToVector(transformed->statement);
+  std::vector<osl_statement_p> analyzedStatements = oslListToVector(analyzed->statement);
+  if (transformedStatements.size() != originalStatements.size() ||
+      analyzedStatements.size() != originalStatements.size()) {
+    return analyze(original, transformed);
+  }
+
+  std::set<std::vector<int>> affected;
+  for (size_t s = 0; s < transformedStatements.size(); s++) {
+    if (osl_relation_equal(transformedStatements[s]->scattering, analyzedStatements[s]->scattering))
+      continue;
+    oslListForeachSingle(originalStatements[s]->scattering, [&affected](osl_relation_p scattering) {
+      affected.insert(betaExtract(scattering));
+    });
+  }
+
+  DependenceMap dependenceMap = analyzedDependences;
+  if (!affected.empty()) {
+    updateViolations(original, transformed, dependenceMap, affected);
+  }
+  return std::move(dependenceMap);
+}
+
+void DependenceAnalyzer::updateViolations(osl_scop_p original, osl_scop_p transformed,
+                                          DependenceMap &dependences,
+                                          const std::set<std::vector<int>> &affected) {
+  isl_ctx *ctx = ISLEnumerator::context();
+  std::vector<std::string> parameters = oslParameterNames(original);
+  std::vector<osl_statement_p> transformedStatements = oslListToVector(transformed->statement);
+  int nbScheduleDims = scheduleDims(transformedStatements);
+
+  std::map<std::vector<int>, size_t> statementIndices;
+  std::vector<osl_statement_p> originalStatements = oslListToVector(original->statement);
+  for (size_t s = 0; s < originalStatements.size(); s++) {
+    oslListForeachSingle(originalStatements[s]->scattering, [&statementIndices,s](osl_relation_p scattering) {
+      statementIndices.emplace(betaExtract(scattering), s);
+    });
+  }
+
+  // Schedules are only built for the statements that have affected dependences.
+  std::map<size_t, std::pair<isl_id *, isl_map *>> schedules;
+  auto schedule = [&](size_t s) {
+    auto found = schedules.find(s);
+    if (found != schedules.end())
+      return found->second;
+    std::string name = "S" + std::to_string(s + 1);
+    isl_id *id = isl_id_alloc(ctx, name.c_str(), nullptr);
+    isl_map *statementSchedule = nullptr;
+    oslListForeachSingle(transformedStatements[s]->scattering, [&](osl_relation_p scattering) {
+      isl_map *part = scheduleMap(scattering, id, nbScheduleDims, parameters);
+      statementSchedule = statementSchedule == nullptr ? part : isl_map_union(statementSchedule, part);
+    });
+    return schedules[s] = std::make_pair(id, statementSchedule);
+  };
+
+  for (auto &element : dependences) {
+    if (affected.count(element.first.first) == 0 && affected.count(element.first.second) == 0)
+      continue;
+    auto source = schedule(statementIndices.at(element.first.first));
+    auto target = schedule(statementIndices.at(element.first.second));
+    isl_map *relation = dependenceRelation(element.second.first, source.first, target.first, parameters);
+    element.second.second = isViolated(relation, source.second, target.second);
+    isl_map_free(relation);
+  }
+
+  for (auto &element : schedules) {
+    isl_id_free(element.second.first);
+    isl_map_free(element.second.second);
+  }
+}
+
+DependenceAnalyzer::DependenceMap ISLFlowAnalyzer::analyze(osl_scop_p original, osl_scop_p transformed) {
+  isl_ctx *ctx = ISLEnumerator::context();
+  std::vector<std::string> parameters = oslParameterNames(original);
+  std::vector<osl_statement_p> statements = oslListToVector(original->statement);
+  int nbScheduleDims = scheduleDims(statements);
+
+  isl_space *paramSpace = isl_space_params_alloc(ctx, parameters.size());
+  for (size_t i = 0; i < parameters.size(); i++) {
+    paramSpace = isl_space_set_dim_name(paramSpace, isl_dim_param, i, parameters[i].c_str());
+  }
+  isl_union_map *schedule = isl_union_map_empty(isl_space_copy(paramSpace));
+  isl_union_map *reads = isl_union_map_empty(isl_space_copy(paramSpace));
+  isl_union_map *writes = isl_union_map_empty(paramSpace);
+
+  // Every scattering relation of a statement is a separate occurrence with its own beta-vector.
+  std::vector<Occurrence> occurrences;
+  for (size_t s = 0; s < statements.size(); s++) {
+    oslListForeachSingle(statements[s]->scattering, [&](osl_relation_p scattering) {
+      size_t index = occurrences.size();
+      std::string name = "S" + std::to_string(index + 1);
+      isl_id *id = isl_id_alloc(ctx, name.c_str(), reinterpret_cast<void *>(static_cast<uintptr_t>(index)));
+      occurrences.push_back(Occurrence {s, betaExtract(scattering), id});
+
+      isl_map *occurrenceSchedule = scheduleMap(scattering, id, nbScheduleDims, parameters);
+      isl_set *domain = isl_set_set_tuple_id(
+            ISLEnumerator::setFromOSLRelation(statements[s]->domain, parameters),
+            isl_id_copy(id));
+      domain = isl_set_intersect(domain, isl_map_domain(isl_map_copy(occurrenceSchedule)));
+      schedule = isl_union_map_add_map(schedule, isl_map_intersect_domain(occurrenceSchedule, isl_set_copy(domain)));
+
+      oslListForeachSingle(statements[s]->access, [&](osl_relation_list_p list) {
+        isl_map *access = isl_map_intersect_domain(accessMap(list->elt, id, parameters), isl_set_copy(domain));
+        if (list->elt->type == OSL_TYPE_READ)
+          reads = isl_union_map_add_map(reads, access);
+        else
+          writes = isl_union_map_add_map(writes, access);
+      });
+      isl_set_free(domain);
+    });
+  }
+
+  // Transformed schedules are attached to the occurrences of the original statements.
+  std::vector<isl_map *> transformedSchedules;
+  if (transformed != nullptr) {
+    std::vector<osl_statement_p> transformedStatements = oslListToVector(transformed->statement);
+    CLINT_ASSERT(transformedStatements.size() == statements.size(),
+                 "Transformed scop must have the same statements as the original one");
+    int nbTransformedDims = scheduleDims(transformedStatements);
+    for (const Occurrence &occurrence : occurrences) {
+      isl_map *occurrenceSchedule = nullptr;
+      oslListForeachSingle(transformedStatements[occurrence.statement]->scattering, [&](osl_relation_p scattering) {
+        isl_map *part = scheduleMap(scattering, occurrence.id, nbTransformedDims, parameters);
+        occurrenceSchedule = occurrenceSchedule == nullptr ? part : isl_map_union(occurrenceSchedule, part);
+      });
+      transformedSchedules.push_back(occurrenceSchedule);
+    }
+  }
+
+  DependenceMap dependenceMap;
+  for (int type : {OSL_DEPENDENCE_RAW, OSL_DEPENDENCE_WAR, OSL_DEPENDENCE_WAW}) {
+    isl_union_map *sinks = type == OSL_DEPENDENCE_RAW ? reads : writes;
+    isl_union_map *sources = type == OSL_DEPENDENCE_WAR ? reads : writes;
+    isl_union_map *dependences = memoryDependences(isl_union_map_copy(sinks), isl_union_map_copy(sources), schedule);
+
+    std::vector<isl_basic_map *> parts;
+    isl_union_map_foreach_map(dependences, &collectMapParts, &parts);
+    isl_union_map_free(dependences);
+
+    for (isl_basic_map *part : parts) {
+      size_t sourceIndex = occurrenceIndex(isl_basic_map_get_tuple_id(part, isl_dim_in));
+      size_t targetIndex = occurrenceIndex(isl_basic_map_get_tuple_id(part, isl_dim_out));
+      const Occurrence &source = occurrences[sourceIndex];
+      const Occurrence &target = occurrences[targetIndex];
+      isl_map *partMap = isl_map_from_basic_map(isl_basic_map_copy(part));
+      bool violated = transformed != nullptr &&
+          isViolated(partMap, transformedSchedules[sourceIndex], transformedSchedules[targetIndex]);
+      isl_map_free(partMap);
+      osl_dependence_p dependence = oslDependence(part, type, source.statement, target.statement);
+      dependenceMap.emplace(std::make_pair(source.beta, target.beta), std::make_pair(dependence, violated));
+      isl_basic_map_free(part);
+    }
+  }
+
+  for (isl_map *map : transformedSchedules) {
+    isl_map_free(map);
+  }
+  for (const Occurrence &occurrence : occurrences) {
+    isl_id_free(occurrence.id);
+  }
+  isl_union_map_free(schedule);
+  isl_union_map_free(reads);
+  isl_union_map_free(writes);
+  return std::move(dependenceMap);
+}
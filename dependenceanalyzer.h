@@ -6,10 +6,16 @@
 #include <osl/extensions/dependence.h>
 
 #include <map>
+#include <set>
 #include <vector>
 
 class DependenceAnalyzer {
 public:
+  enum class Backend {
+    Candl,
+    ISL
+  };
+
   typedef std::pair<osl_dependence_p, bool> Dependence;
   typedef std::multimap<std::pair<std::vector<int>, std::vector<int>>,
                         Dependence> DependenceMap;
@@ -19,6 +25,33 @@ public:
 
   virtual DependenceMap analyze(osl_scop_p original,
                                 osl_scop_p transformed = nullptr) = 0;
+
+  /**
+   * @brief Analyze @p transformed knowing the result @p analyzedDependences of the analysis of @p analyzed.
+   *
+   * Dependences only depend on the original scop, and the legality of a dependence only depends
+   * on the schedules of its source and target statements.  Only the dependences of statements
+   * whose scattering differs between @p analyzed and @p transformed are rechecked, so the cost
+   * follows the size of the change rather than the size of the scop.
+   */
+  DependenceMap reanalyze(osl_scop_p original, osl_scop_p transformed,
+                          osl_scop_p analyzed, const DependenceMap &analyzedDependences);
+
+  /**
+   * @brief Recompute the violation flags of the @p dependences with a source or a target in @p affected.
+   * Occurrences are identified by their beta-vectors in @p original.  The default implementation
+   * checks with isl that the target of each dependence is scheduled after its source.
+   */
+  virtual void updateViolations(osl_scop_p original, osl_scop_p transformed, DependenceMap &dependences,
+                                const std::set<std::vector<int>> &affected);
+
+  static DependenceAnalyzer *create(Backend backend);
+
+  /// Backend used by the scops and the transformation worker.  Candl unless changed.
+  static Backend backend();
+  static void setBackend(Backend backend);
+
+  static const char *backendName(Backend backend);
 };
 
 class CandlRAII {
@@ -40,6 +73,11 @@ private:
   candl_options_p m_options;
 };
 
+/**
+ * @brief Dependence analyzer based on Candl.
+ * Candl is not reentrant, all Candl calls of the process are serialized by a single mutex so
+ * that the GUI thread and the workers may analyze concurrently.
+ */
 class CandlAnalyzer : public DependenceAnalyzer{
 public:
   CandlAnalyzer();
@@ -56,4 +94,19 @@ private:
 
 };
 
+/**
+ * @brief Dependence analyzer based on the isl dataflow analysis.
+ *
+ * Access relations are built from the access extensions of the original scop and memory-based
+ * RAW, WAR and WAW dependences are computed with isl_union_access_info_compute_flow under the
+ * original schedule.  Each occurrence, i.e. each scattering relation of a statement, is analyzed
+ * separately so that relation unions are supported.  A dependence is violated by the transformed
+ * scop if its target is not scheduled strictly after its source.  The produced osl dependences
+ * have no access dimensions in their domain; they are never freed, like the Candl ones.
+ */
+class ISLFlowAnalyzer : public DependenceAnalyzer {
+public:
+  DependenceMap analyze(osl_scop_p original, osl_scop_p transformed = nullptr) override;
+};
+
 #endif // DEPENDENCEANALYZER_H
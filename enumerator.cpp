@@ -1,46 +1,274 @@
 #include "enumerator.h"
+#include "oslutils.h"
+
+#include <isl/aff.h>
+#include <isl/constraint.h>
+#include <isl/ilp.h>
+#include <isl/local_space.h>
+#include <isl/val.h>
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
+#include <string>
+#include <thread>
 #include <vector>
 
-/// Application-wide ISL context
-ISLContextRAII ISLEnumerator::m_islContext;
-
 const int Enumerator::NO_COORD;
 const int Enumerator::NO_DIMENSION;
 
 namespace {
-isl_stat addISLPointToVector(isl_point *point, void *vect) {
-  CLINT_ASSERT(point != nullptr, "Point is nullptr");
-  CLINT_ASSERT(vect != nullptr, "Vector is nullptr");
-
-  std::vector<std::vector<int> > &vector = *static_cast<std::vector<std::vector<int> > *>(vect);
-  isl_space *space = isl_point_get_space(point);
-  const unsigned nbDims = isl_space_dim(space, isl_dim_all);
-  std::vector<int> pointVector;
-  pointVector.reserve(nbDims);
+void readISLPointCoordinates(isl_point *point, PointBuffer::value_type *row, unsigned nbDims) {
   for (unsigned i = 0; i < nbDims; i++) {
     isl_val *val = isl_point_get_coordinate_val(point, isl_dim_all, i);
     long value = isl_val_get_num_si(val);
     CLINT_ASSERT(isl_val_get_den_si(val) == 1, "Fractional point");
     CLINT_ASSERT(value <= INT_MAX, "Integer overflow");
-    int ivalue = static_cast<int>(value);
-    pointVector.push_back(ivalue);
+    row[i] = static_cast<PointBuffer::value_type>(value);
     isl_val_free(val);
   }
-  isl_space_free(space);
+}
+
+isl_stat addISLPointToBuffer(isl_point *point, void *buf) {
+  CLINT_ASSERT(point != nullptr, "Point is nullptr");
+  CLINT_ASSERT(buf != nullptr, "Buffer is nullptr");
+
+  PointBuffer &buffer = *static_cast<PointBuffer *>(buf);
+  readISLPointCoordinates(point, buffer.appendRow(), buffer.stride());
   isl_point_free(point);
-  vector.push_back(std::move(pointVector));
 
   return isl_stat_ok;
 }
+
+struct PointVisitorState {
+  const Enumerator::PointVisitor &visitor;
+  std::vector<PointBuffer::value_type> row;
+};
+
+isl_stat visitISLPoint(isl_point *point, void *user) {
+  CLINT_ASSERT(point != nullptr, "Point is nullptr");
+  CLINT_ASSERT(user != nullptr, "Visitor is nullptr");
+
+  PointVisitorState &state = *static_cast<PointVisitorState *>(user);
+  readISLPointCoordinates(point, state.row.data(), state.row.size());
+  isl_point_free(point);
+
+  // Returning an error from the callback is the only way to stop the ISL traversal.
+  bool proceed = state.visitor(PointBuffer::Row(state.row.data(), state.row.size()));
+  return proceed ? isl_stat_ok : isl_stat_error;
+}
+
+/// Build an ISL basic map from a single part of the OpenScop relation union.
+/// Local (existentially quantified) dimensions are introduced as extra output
+/// dimensions and projected out once all the constraints are added.
+__isl_give isl_basic_map *basicMapFromOSLRelationPart(isl_ctx *ctx, osl_relation_p relation,
+                                                      const std::vector<std::string> &parameters) {
+  const int nbOutput = relation->nb_output_dims;
+  const int nbInput  = relation->nb_input_dims;
+  const int nbLocal  = relation->nb_local_dims;
+  const int nbParam  = relation->nb_parameters;
+  CLINT_ASSERT(relation->nb_columns == nbOutput + nbInput + nbLocal + nbParam + 2,
+               "Malformed relation");
+  CLINT_ASSERT(parameters.size() <= static_cast<size_t>(nbParam), "More parameter names than parameters");
+
+  isl_space *space = isl_space_alloc(ctx, nbParam, nbInput, nbOutput + nbLocal);
+  for (size_t i = 0; i < parameters.size(); i++) {
+    space = isl_space_set_dim_name(space, isl_dim_param, i, parameters[i].c_str());
+  }
+  isl_local_space *localSpace = isl_local_space_from_space(isl_space_copy(space));
+  isl_basic_map *bmap = isl_basic_map_universe(space);
+
+  for (int row = 0; row < relation->nb_rows; ++row) {
+    osl_int_t *line = relation->m[row];
+    isl_constraint *constraint = osl_int_zero(relation->precision, line[0]) ?
+          isl_constraint_alloc_equality(isl_local_space_copy(localSpace)) :
+          isl_constraint_alloc_inequality(isl_local_space_copy(localSpace));
+    int column = 1;
+    for (int i = 0; i < nbOutput; ++i, ++column) {
+      long value = osl_int_get_si(relation->precision, line[column]);
+      constraint = isl_constraint_set_coefficient_val(constraint, isl_dim_out, i, isl_val_int_from_si(ctx, value));
+    }
+    for (int i = 0; i < nbInput; ++i, ++column) {
+      long value = osl_int_get_si(relation->precision, line[column]);
+      constraint = isl_constraint_set_coefficient_val(constraint, isl_dim_in, i, isl_val_int_from_si(ctx, value));
+    }
+    for (int i = 0; i < nbLocal; ++i, ++column) {
+      long value = osl_int_get_si(relation->precision, line[column]);
+      constraint = isl_constraint_set_coefficient_val(constraint, isl_dim_out, nbOutput + i, isl_val_int_from_si(ctx, value));
+    }
+    for (int i = 0; i < nbParam; ++i, ++column) {
+      long value = osl_int_get_si(relation->precision, line[column]);
+      constraint = isl_constraint_set_coefficient_val(constraint, isl_dim_param, i, isl_val_int_from_si(ctx, value));
+    }
+    long constant = osl_int_get_si(relation->precision, line[column]);
+    constraint = isl_constraint_set_constant_val(constraint, isl_val_int_from_si(ctx, constant));
+    bmap = isl_basic_map_add_constraint(bmap, constraint);
+  }
+  isl_local_space_free(localSpace);
+
+  return isl_basic_map_project_out(bmap, isl_dim_out, nbOutput, nbLocal);
+}
+
+__isl_give isl_map *mapFromOSLRelationUnion(isl_ctx *ctx, osl_relation_p relation,
+                                            const std::vector<std::string> &parameters) {
+  CLINT_ASSERT(relation != nullptr, "Relation pointer is null");
+
+  isl_map *map = isl_map_from_basic_map(basicMapFromOSLRelationPart(ctx, relation, parameters));
+  for (osl_relation_p part = relation->next; part != nullptr; part = part->next) {
+    CLINT_ASSERT(part->nb_output_dims == relation->nb_output_dims &&
+                 part->nb_input_dims == relation->nb_input_dims &&
+                 part->nb_parameters == relation->nb_parameters,
+                 "Relation union parts live in different spaces");
+    map = isl_map_union(map, isl_map_from_basic_map(basicMapFromOSLRelationPart(ctx, part, parameters)));
+  }
+  return map;
+}
+
+long islValToLong(__isl_take isl_val *val) {
+  CLINT_ASSERT(isl_val_is_int(val) == isl_bool_true, "Non-integer coefficient");
+  long value = isl_val_get_num_si(val);
+  isl_val_free(val);
+  return value;
+}
+
+struct OSLRowFiller {
+  osl_relation_p relation;
+  int row;
+};
+
+isl_stat addISLConstraintToRelation(isl_constraint *constraint, void *user) {
+  OSLRowFiller &filler = *static_cast<OSLRowFiller *>(user);
+  osl_relation_p relation = filler.relation;
+  CLINT_ASSERT(filler.row < relation->nb_rows, "Constraint count mismatch");
+
+  osl_int_t *line = relation->m[filler.row++];
+  const int precision = relation->precision;
+  osl_int_set_si(precision, &line[0], isl_constraint_is_equality(constraint) ? 0 : 1);
+  int column = 1;
+  for (int i = 0; i < relation->nb_output_dims; ++i, ++column) {
+    osl_int_set_si(precision, &line[column],
+                   islValToLong(isl_constraint_get_coefficient_val(constraint, isl_dim_out, i)));
+  }
+  for (int i = 0; i < relation->nb_input_dims; ++i, ++column) {
+    osl_int_set_si(precision, &line[column],
+                   islValToLong(isl_constraint_get_coefficient_val(constraint, isl_dim_in, i)));
+  }
+  for (int i = 0; i < relation->nb_local_dims; ++i, ++column) {
+    osl_int_set_si(precision, &line[column],
+                   islValToLong(isl_constraint_get_coefficient_val(constraint, isl_dim_div, i)));
+  }
+  for (int i = 0; i < relation->nb_parameters; ++i, ++column) {
+    osl_int_set_si(precision, &line[column],
+                   islValToLong(isl_constraint_get_coefficient_val(constraint, isl_dim_param, i)));
+  }
+  osl_int_set_si(precision, &line[column],
+                 islValToLong(isl_constraint_get_constant_val(constraint)));
+
+  isl_constraint_free(constraint);
+  return isl_stat_ok;
+}
+
+/// Build a single OpenScop relation part from an ISL basic map.  ISL divs
+/// become OpenScop local dimensions, same as in the extended polylib format.
+osl_relation_p basicMapToOSLRelationPart(__isl_keep isl_basic_map *bmap) {
+  const int nbOutput = isl_basic_map_dim(bmap, isl_dim_out);
+  const int nbInput  = isl_basic_map_dim(bmap, isl_dim_in);
+  const int nbLocal  = isl_basic_map_dim(bmap, isl_dim_div);
+  const int nbParam  = isl_basic_map_dim(bmap, isl_dim_param);
+  const int nbRows   = isl_basic_map_n_constraint(bmap);
+
+  osl_relation_p relation = osl_relation_pmalloc(osl_util_get_precision(), nbRows,
+                                                 nbOutput + nbInput + nbLocal + nbParam + 2);
+  relation->type = OSL_UNDEFINED;
+  relation->nb_output_dims = nbOutput;
+  relation->nb_input_dims  = nbInput;
+  relation->nb_local_dims  = nbLocal;
+  relation->nb_parameters  = nbParam;
+
+  OSLRowFiller filler {relation, 0};
+  isl_basic_map_foreach_constraint(bmap, &addISLConstraintToRelation, &filler);
+  CLINT_ASSERT(filler.row == nbRows, "Constraint count mismatch");
+  return relation;
+}
+
+isl_stat addISLBasicMapToRelation(isl_basic_map *bmap, void *user) {
+  osl_relation_p *relation = static_cast<osl_relation_p *>(user);
+  osl_relation_add(relation, basicMapToOSLRelationPart(bmap));
+  isl_basic_map_free(bmap);
+  return isl_stat_ok;
+}
+
+/// Convert an optimum computed by ISL to a bound.  Infinite values are clamped.
+int islOptimumToInt(__isl_take isl_val *val) {
+  int result;
+  if (isl_val_is_infty(val) == isl_bool_true) {
+    result = INT_MAX;
+  } else if (isl_val_is_neginfty(val) == isl_bool_true) {
+    result = INT_MIN;
+  } else {
+    CLINT_ASSERT(isl_val_is_int(val) == isl_bool_true, "Non-integer optimum");
+    long value = isl_val_get_num_si(val);
+    CLINT_ASSERT(value <= INT_MAX && value >= INT_MIN, "Integer overflow");
+    result = static_cast<int>(value);
+  }
+  isl_val_free(val);
+  return result;
+}
+
 } // end anonymous namespace
 
-std::vector<std::vector<int> > ISLEnumerator::enumerate(osl_relation_p relation, const std::vector<int> &dimensions) {
+__isl_give isl_map *ISLEnumerator::mapFromOSLRelation(osl_relation_p relation,
+                                                      const std::vector<std::string> &parameters) {
+  return mapFromOSLRelationUnion(context(), relation, parameters);
+}
+
+__isl_give isl_set *ISLEnumerator::setFromOSLRelation(osl_relation_p relation,
+                                                      const std::vector<std::string> &parameters) {
+  CLINT_ASSERT(relation->nb_input_dims == 0, "Relation is not a set");
+  return isl_map_range(mapFromOSLRelationUnion(context(), relation, parameters));
+}
+
+__isl_give isl_basic_map *ISLEnumerator::basicMapFromOSLRelation(osl_relation_p relation,
+                                                                 const std::vector<std::string> &parameters) {
+  CLINT_ASSERT(relation != nullptr, "Relation pointer is null");
+  CLINT_ASSERT(relation->next == nullptr, "Relation is a union");
+  return basicMapFromOSLRelationPart(context(), relation, parameters);
+}
+
+__isl_give isl_basic_set *ISLEnumerator::basicSetFromOSLRelation(osl_relation_p relation,
+                                                                 const std::vector<std::string> &parameters) {
+  CLINT_ASSERT(relation != nullptr, "Relation pointer is null");
+  CLINT_ASSERT(relation->next == nullptr, "Relation is a union");
+  CLINT_ASSERT(relation->nb_input_dims == 0, "Relation is not a set");
+  return isl_basic_map_range(basicMapFromOSLRelationPart(context(), relation, parameters));
+}
+
+osl_relation_p ISLEnumerator::mapToOSLRelation(isl_map *map) {
+  CLINT_ASSERT(map != nullptr, "ISL object is null");
+  osl_relation_p relation = nullptr;
+  isl_map_foreach_basic_map(map, &addISLBasicMapToRelation, &relation);
+  return relation;
+}
+
+osl_relation_p ISLEnumerator::setToOSLRelation(isl_set *set) {
+  CLINT_ASSERT(set != nullptr, "ISL object is null");
+  isl_map *map = isl_map_from_range(isl_set_copy(set));
+  osl_relation_p relation = mapToOSLRelation(map);
+  isl_map_free(map);
+  return relation;
+}
+
+osl_relation_p ISLEnumerator::basicSetToOSLRelation(isl_basic_set *basicSet) {
+  CLINT_ASSERT(basicSet != nullptr, "ISL object is null");
+  isl_basic_map *bmap = isl_basic_map_from_range(isl_basic_set_copy(basicSet));
+  osl_relation_p relation = basicMapToOSLRelationPart(bmap);
+  isl_basic_map_free(bmap);
+  return relation;
+}
+
+__isl_give isl_set *ISLEnumerator::projectedSet(osl_relation_p relation, const std::vector<int> &dimensions) {
   isl_set *set = setFromOSLRelation(relation);
 
-  std::vector<std::vector<int> > points;
   std::vector<int> allDimensions, dimensionsToProjectOut;
   // Fill non-local dimension indices.
   allDimensions.reserve(relation->nb_columns - 2);
@@ -67,11 +295,54 @@ std::vector<std::vector<int> > ISLEnumerator::enumerate(osl_relation_p relation,
     std::tie(dim_type, index) = tuple;
     set = isl_set_project_out(set, dim_type, index, 1);
   }
-  isl_set_foreach_point(set, &addISLPointToVector, &points);
+  return set;
+}
+
+PointBuffer ISLEnumerator::enumerate(osl_relation_p relation, const std::vector<int> &dimensions) {
+  isl_set *set = projectedSet(relation, dimensions);
+  // All points share the space of the projected set, so the stride is known before the traversal.
+  PointBuffer points(isl_set_dim(set, isl_dim_all));
+  isl_set_foreach_point(set, &addISLPointToBuffer, &points);
   isl_set_free(set);
   return std::move(points); // Force RVO.
 }
 
+void ISLEnumerator::forEachPoint(osl_relation_p relation, const std::vector<int> &dimensions,
+                                 const PointVisitor &visitor) {
+  isl_set *set = projectedSet(relation, dimensions);
+  PointVisitorState state {visitor, std::vector<PointBuffer::value_type>(isl_set_dim(set, isl_dim_all))};
+  isl_set_foreach_point(set, &visitISLPoint, &state);
+  isl_set_free(set);
+}
+
+std::vector<std::pair<int, int>> ISLEnumerator::bounds(osl_relation_p relation, const std::vector<int> &dimensions) {
+  std::vector<std::pair<int, int>> result;
+  result.reserve(dimensions.size());
+
+  isl_set *set = setFromOSLRelation(relation);
+  if (isl_set_is_empty(set) == isl_bool_true) {
+    isl_set_free(set);
+    result.assign(dimensions.size(), std::make_pair(0, 0));
+    return std::move(result);
+  }
+
+  // Optimize the affine form equal to the dimension over the set, no points are enumerated.
+  isl_local_space *localSpace = isl_local_space_from_space(isl_set_get_space(set));
+  for (int dim : dimensions) {
+    isl_dim_type dimType;
+    int index;
+    std::tie(dimType, index) = dimFromOSL(relation, dim);
+    isl_aff *objective = isl_aff_var_on_domain(isl_local_space_copy(localSpace), dimType, index);
+    int minimum = islOptimumToInt(isl_set_min_val(set, objective));
+    int maximum = islOptimumToInt(isl_set_max_val(set, objective));
+    isl_aff_free(objective);
+    result.emplace_back(minimum, maximum);
+  }
+  isl_local_space_free(localSpace);
+  isl_set_free(set);
+  return std::move(result);
+}
+
 osl_relation_p ISLEnumerator::scheduledDomain(osl_relation_p domain, osl_relation_p schedule) {
   CLINT_ASSERT(domain->nb_input_dims == 0, "Domain is not a set");
   CLINT_ASSERT(domain->nb_parameters == schedule->nb_parameters,
@@ -86,5 +357,213 @@ osl_relation_p ISLEnumerator::scheduledDomain(osl_relation_p domain, osl_relatio
   return result;
 }
 
+void Enumerator::forEachPoint(osl_relation_p relation, const std::vector<int> &dimensions,
+                              const PointVisitor &visitor) {
+  PointBuffer points = enumerate(relation, dimensions);
+  for (PointBuffer::Row point : points) {
+    if (!visitor(point))
+      break;
+  }
+}
+
+std::vector<std::pair<int, int>> Enumerator::bounds(osl_relation_p relation, const std::vector<int> &dimensions) {
+  std::vector<std::pair<int, int>> result(dimensions.size(), std::make_pair(INT_MAX, INT_MIN));
+  forEachPoint(relation, dimensions, [&result](PointBuffer::Row point) {
+    for (size_t i = 0; i < point.size(); ++i) {
+      result[i].first  = std::min(result[i].first, point[i]);
+      result[i].second = std::max(result[i].second, point[i]);
+    }
+    return true;
+  });
+  for (std::pair<int, int> &bound : result) {
+    if (bound.first > bound.second) // No points.
+      bound = std::make_pair(0, 0);
+  }
+  return std::move(result);
+}
+
+std::vector<PointBuffer> Enumerator::enumerateMany(const std::vector<Request> &requests) {
+  std::vector<PointBuffer> results;
+  results.reserve(requests.size());
+  for (const Request &request : requests) {
+    results.push_back(enumerate(request.relation, request.dimensions));
+  }
+  return std::move(results);
+}
+
+ISLEnumerator::ISLEnumerator(unsigned nbThreads) :
+  m_nbThreads(nbThreads), m_batchNext(0) {
+  if (m_nbThreads == 0) {
+    m_nbThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+ISLContextRAII &ISLEnumerator::context() {
+  thread_local ISLContextRAII threadContext;
+  return threadContext;
+}
+
+void ISLEnumerator::startPool() {
+  // The calling thread takes part in every batch.
+  m_pool.reserve(m_nbThreads - 1);
+  for (unsigned i = 1; i < m_nbThreads; ++i) {
+    m_pool.emplace_back(&ISLEnumerator::poolWorker, this);
+  }
+}
+
+void ISLEnumerator::poolWorker() {
+  unsigned seenBatch = 0;
+  std::unique_lock<std::mutex> lock(m_poolMutex);
+  while (true) {
+    m_batchStarted.wait(lock, [this,seenBatch] { return m_stopping || m_batchId != seenBatch; });
+    if (m_stopping)
+      return;
+    seenBatch = m_batchId;
+    // The batch may already be over if this thread woke up late.
+    if (m_batchRequests == nullptr)
+      continue;
+
+    const std::vector<Request> &requests = *m_batchRequests;
+    std::vector<PointBuffer> &results = *m_batchResults;
+    ++m_activeWorkers;
+    lock.unlock();
+    processBatch(requests, results);
+    lock.lock();
+    if (--m_activeWorkers == 0)
+      m_batchFinished.notify_all();
+  }
+}
+
+void ISLEnumerator::processBatch(const std::vector<Request> &requests, std::vector<PointBuffer> &results) {
+  // Threads pick the next unprocessed request until none is left.  Each of them enumerates in
+  // its own thread-local ISL context; the results are written to distinct slots.
+  for (size_t i = m_batchNext++; i < requests.size(); i = m_batchNext++) {
+    results[i] = enumerate(requests[i].relation, requests[i].dimensions);
+  }
+}
+
+std::vector<PointBuffer> ISLEnumerator::enumerateMany(const std::vector<Request> &requests) {
+  if (m_nbThreads <= 1 || requests.size() <= 1) {
+    return Enumerator::enumerateMany(requests);
+  }
+
+  std::lock_guard<std::mutex> batchLock(m_batchMutex);
+  if (m_pool.empty())
+    startPool();
+
+  std::vector<PointBuffer> results(requests.size());
+  {
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+    m_batchRequests = &requests;
+    m_batchResults = &results;
+    m_batchNext = 0;
+    ++m_batchId;
+  }
+  m_batchStarted.notify_all();
+
+  processBatch(requests, results);
+
+  // All requests are taken, wait for the threads still enumerating theirs.
+  std::unique_lock<std::mutex> lock(m_poolMutex);
+  m_batchRequests = nullptr;
+  m_batchResults = nullptr;
+  m_batchFinished.wait(lock, [this] { return m_activeWorkers == 0; });
+  return std::move(results);
+}
+
 ISLEnumerator::~ISLEnumerator() {
+  {
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+    m_stopping = true;
+  }
+  m_batchStarted.notify_all();
+  for (std::thread &thread : m_pool) {
+    thread.join();
+  }
+}
+
+const size_t CachingEnumerator::DEFAULT_BUDGET;
+
+CachingEnumerator::CachingEnumerator(Enumerator *enumerator, size_t budget) :
+  m_enumerator(enumerator),
+  m_cache(budget, [](Entry &entry) { osl_relation_free(entry.relation); }) {
+  CLINT_ASSERT(enumerator != nullptr, "Wrapped enumerator is null");
+}
+
+CachingEnumerator::~CachingEnumerator() {
+  clear();
+  delete m_enumerator;
+}
+
+bool CachingEnumerator::find(size_t hash, osl_relation_p relation, const std::vector<int> &dimensions,
+                             PointBuffer &points) {
+  return m_cache.find(hash, [relation,&dimensions](const Entry &entry) {
+    return entry.dimensions == dimensions && osl_relation_equal(entry.relation, relation);
+  }, [&points](const Entry &entry) {
+    points = entry.points;
+  });
+}
+
+void CachingEnumerator::insert(size_t hash, osl_relation_p relation, const std::vector<int> &dimensions,
+                               const PointBuffer &points) {
+  size_t bytes = points.size() * points.stride() * sizeof(PointBuffer::value_type);
+  m_cache.insert(hash, bytes, [relation,&dimensions](const Entry &entry) {
+    return entry.dimensions == dimensions && osl_relation_equal(entry.relation, relation);
+  }, [relation,&dimensions,&points]() {
+    return Entry{osl_relation_clone(relation), dimensions, points};
+  });
+}
+
+PointBuffer CachingEnumerator::enumerate(osl_relation_p relation, const std::vector<int> &dimensions) {
+  size_t hash = oslRelationHash(relation);
+  PointBuffer points;
+  if (find(hash, relation, dimensions, points))
+    return std::move(points);
+
+  points = m_enumerator->enumerate(relation, dimensions);
+  insert(hash, relation, dimensions, points);
+  return std::move(points);
+}
+
+std::vector<PointBuffer> CachingEnumerator::enumerateMany(const std::vector<Request> &requests) {
+  std::vector<PointBuffer> results(requests.size());
+  std::vector<size_t> hashes(requests.size());
+  std::vector<Request> missed;
+  std::vector<size_t> missedIndices;
+  for (size_t i = 0; i < requests.size(); ++i) {
+    hashes[i] = oslRelationHash(requests[i].relation);
+    if (!find(hashes[i], requests[i].relation, requests[i].dimensions, results[i])) {
+      missed.push_back(requests[i]);
+      missedIndices.push_back(i);
+    }
+  }
+  if (missed.empty())
+    return std::move(results);
+
+  // Only the missed requests go to the wrapped enumerator, still as a single batch.
+  std::vector<PointBuffer> enumerated = m_enumerator->enumerateMany(missed);
+  for (size_t i = 0; i < missedIndices.size(); ++i) {
+    size_t index = missedIndices[i];
+    insert(hashes[index], requests[index].relation, requests[index].dimensions, enumerated[i]);
+    results[index] = std::move(enumerated[i]);
+  }
+  return std::move(results);
+}
+
+void CachingEnumerator::forEachPoint(osl_relation_p relation, const std::vector<int> &dimensions,
+                                     const PointVisitor &visitor) {
+  PointBuffer points;
+  // Streamed points are not stored on a miss, the caller asked not to materialize them.
+  if (!find(oslRelationHash(relation), relation, dimensions, points)) {
+    m_enumerator->forEachPoint(relation, dimensions, visitor);
+    return;
+  }
+  for (PointBuffer::Row row : points) {
+    if (!visitor(row))
+      break;
+  }
+}
+
+std::vector<std::pair<int, int>> CachingEnumerator::bounds(osl_relation_p relation, const std::vector<int> &dimensions) {
+  return m_enumerator->bounds(relation, dimensions);
 }
@@ -7,23 +7,76 @@
 
 #include <osl/osl.h>
 
+#include <atomic>
 #include <climits>
+#include <condition_variable>
 #include <cstring>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "lrucache.h"
 #include "macros.h"
+#include "pointbuffer.h"
 
 class Enumerator {
 public:
+  /**
+   * @brief A single enumeration task: a relation and the dimensions to project it onto.
+   */
+  struct Request {
+    osl_relation_p relation;
+    std::vector<int> dimensions;
+  };
+
+  /**
+   * @brief Callback invoked for each enumerated point.  The row view is only valid during the call.
+   * Return false to stop the enumeration.
+   */
+  typedef std::function<bool (PointBuffer::Row)> PointVisitor;
+
   /**
    * @brief Get a list of integer points in the polytope, projected to a set of specific dimensions.
    * @param [in] relation   Union of relations that defines a polytope.
    * @param [in] dimensions Vector of indices of dimensions to project points onto.
-   * @return The vector of integer points inside the polyhedron, each point represented as a vector of integer coordinates ordered
-   * by the dimension index.
+   * @return The buffer of integer points inside the polyhedron, each point represented as a row of integer coordinates ordered
+   * by the dimension index.  The stride of the buffer equals the number of dimensions.
+   */
+  virtual PointBuffer enumerate(osl_relation_p relation, const std::vector<int> &dimensions) = 0;
+  /**
+   * @brief Enumerate multiple polytopes in one call.  The default implementation processes
+   * the requests sequentially; implementations may process them concurrently.
+   * Relations must not be modified until the call returns.
+   * @param [in] requests Relations and dimensions to project them onto.
+   * @return Buffers of integer points, one per request and in the order of requests.
+   */
+  virtual std::vector<PointBuffer> enumerateMany(const std::vector<Request> &requests);
+  /**
+   * @brief Visit integer points in the polytope, projected to a set of specific dimensions, without
+   * storing them.  The default implementation enumerates all points first; implementations should
+   * stream them instead.
+   * @param [in] relation   Union of relations that defines a polytope.
+   * @param [in] dimensions Vector of indices of dimensions to project points onto.
+   * @param [in] visitor    Callback receiving the coordinates of each point ordered by the dimension index.
    */
-  virtual std::vector<std::vector<int>> enumerate(osl_relation_p relation, const std::vector<int> &dimensions) = 0;
+  virtual void forEachPoint(osl_relation_p relation, const std::vector<int> &dimensions,
+                            const PointVisitor &visitor);
+  /**
+   * @brief Get the minimum and maximum values of integer points in the polytope along specific dimensions.
+   * The default implementation folds over the enumerated points; implementations should compute
+   * the bounds without enumeration.
+   * @param [in] relation   Union of relations that defines a polytope.
+   * @param [in] dimensions Vector of indices of dimensions to compute bounds for.
+   * @return A (minimum, maximum) pair for each dimension, in the order of dimensions.  Both values are 0
+   * if the polytope is empty.  Unbounded values are clamped to INT_MIN and INT_MAX.
+   */
+  virtual std::vector<std::pair<int, int>> bounds(osl_relation_p relation, const std::vector<int> &dimensions);
   /**
    * @brief Virtual desctructor.  Reimplement in all derived classes with non-trival memory management.
    */
@@ -58,15 +111,29 @@ public:
   }
 
 private:
-  isl_ctx *m_ctx;
+  isl_ctx *m_ctx = nullptr;
 };
 
 /**
  * @brief An implementation of Enumerator using ISL library.
+ * ISL contexts are not thread-safe, so each thread works in its own context
+ * returned by context().  ISL objects never leave the thread that created them.
+ * enumerateMany distributes the requests over a pool of threads that is started on first
+ * use and lives as long as the enumerator, so their contexts are reused between batches.
  */
 class ISLEnumerator : public Enumerator {
 public:
-  std::vector<std::vector<int> > enumerate(osl_relation_p relation, const std::vector<int> &dimensions) override;
+  /**
+   * @brief Construct an enumerator.
+   * @param [in] nbThreads Maximum number of threads used by enumerateMany, 0 for the number of cores.
+   */
+  explicit ISLEnumerator(unsigned nbThreads = 0);
+
+  PointBuffer enumerate(osl_relation_p relation, const std::vector<int> &dimensions) override;
+  std::vector<PointBuffer> enumerateMany(const std::vector<Request> &requests) override;
+  void forEachPoint(osl_relation_p relation, const std::vector<int> &dimensions,
+                    const PointVisitor &visitor) override;
+  std::vector<std::pair<int, int>> bounds(osl_relation_p relation, const std::vector<int> &dimensions) override;
 
   ~ISLEnumerator() override;
 
@@ -88,46 +155,65 @@ public:
     CLINT_UNREACHABLE;
   }
 
-  static inline __isl_give isl_set *setFromOSLRelation(osl_relation_p relation, osl_names_p names = nullptr) {
-    CLINT_ASSERT(relation->nb_input_dims == 0, "Relation is not a set");
-    return osl2isl(isl_set_read_from_str, relation, names);
-  }
+  /// Conversions from OpenScop relations.  The first parameters of the result are named after
+  /// @p parameters, which ISL uses to match parameters when combining objects.
+  static __isl_give isl_set *setFromOSLRelation(osl_relation_p relation,
+                                                const std::vector<std::string> &parameters = std::vector<std::string>());
+  static __isl_give isl_map *mapFromOSLRelation(osl_relation_p relation,
+                                                const std::vector<std::string> &parameters = std::vector<std::string>());
+  static __isl_give isl_basic_set *basicSetFromOSLRelation(osl_relation_p relation,
+                                                           const std::vector<std::string> &parameters = std::vector<std::string>());
+  static __isl_give isl_basic_map *basicMapFromOSLRelation(osl_relation_p relation,
+                                                           const std::vector<std::string> &parameters = std::vector<std::string>());
 
-  static inline __isl_give isl_map *mapFromOSLRelation(osl_relation_p relation, osl_names_p names = nullptr) {
-    return osl2isl(isl_map_read_from_str, relation, names);
-  }
+  static osl_relation_p setToOSLRelation(__isl_keep isl_set *set);
+  static osl_relation_p basicSetToOSLRelation(__isl_keep isl_basic_set *basicSet);
+  static osl_relation_p mapToOSLRelation(__isl_keep isl_map *map);
 
-  static inline __isl_give isl_basic_set *basicSetFromOSLRelation(osl_relation_p relation, osl_names_p names = nullptr) {
+  // Reference conversions through the polylib textual format.  They are
+  // slower than the direct ones above and kept for benchmarking only.
+  static inline __isl_give isl_set *setFromOSLRelationText(osl_relation_p relation, osl_names_p names = nullptr) {
     CLINT_ASSERT(relation->nb_input_dims == 0, "Relation is not a set");
-    return osl2isl(isl_basic_set_read_from_str, relation, names);
-  }
-
-  static inline __isl_give isl_basic_map *basicMapFromOSLRelation(osl_relation_p relation, osl_names_p names = nullptr) {
-    return osl2isl(isl_basic_map_read_from_str, relation, names);
+    return osl2isl(isl_set_read_from_str, relation, names);
   }
 
-  static inline osl_relation_p setToOSLRelation(isl_set *set) {
+  static inline osl_relation_p setToOSLRelationText(isl_set *set) {
     return isl2osl(isl_printer_print_set, set);
   }
 
-  static inline osl_relation_p basicSetToOSLRelation(isl_basic_set *basicSet) {
-    return isl2osl(isl_printer_print_basic_set, basicSet);
-  }
-
-  static inline osl_relation_p mapToOSLRelation(isl_map *map) {
-    return isl2osl(isl_printer_print_map, map);
-  }
-
   static osl_relation_p scheduledDomain(osl_relation_p domain, osl_relation_p schedule);
 
+  /**
+   * @brief ISL context owned by the calling thread.
+   */
+  static ISLContextRAII &context();
+
 private:
-  static ISLContextRAII m_islContext;
+  unsigned m_nbThreads;
+
+  void startPool();
+  void poolWorker();
+  void processBatch(const std::vector<Request> &requests, std::vector<PointBuffer> &results);
+
+  std::vector<std::thread> m_pool;
+  std::mutex m_batchMutex;          ///< Serializes enumerateMany calls.
+  std::mutex m_poolMutex;           ///< Protects the batch state below.
+  std::condition_variable m_batchStarted;
+  std::condition_variable m_batchFinished;
+  const std::vector<Request> *m_batchRequests = nullptr;
+  std::vector<PointBuffer> *m_batchResults = nullptr;
+  std::atomic<size_t> m_batchNext;
+  unsigned m_batchId = 0;
+  unsigned m_activeWorkers = 0;
+  bool m_stopping = false;
+
+  static __isl_give isl_set *projectedSet(osl_relation_p relation, const std::vector<int> &dimensions);
 
   template <typename T>
   static osl_relation_p isl2osl(isl_printer *(&Func)(isl_printer *, T *), T *t) {
     CLINT_ASSERT(t != nullptr, "ISL object is null");
 
-    isl_printer *prn = isl_printer_to_str(m_islContext);
+    isl_printer *prn = isl_printer_to_str(context());
     prn = isl_printer_set_output_format(prn, ISL_FORMAT_EXT_POLYLIB);
     prn = Func(prn, t);
     char *str = isl_printer_get_str(prn);
@@ -145,11 +231,76 @@ private:
   static T *osl2isl(T *(&Func)(isl_ctx *, const char *), osl_relation_p relation, osl_names_p names = nullptr) {
     CLINT_ASSERT(relation != nullptr, "Relation pointer is null");
 
-    char *string = osl_relation_spprint_polylib(relation, NULL);
-    T *t = Func(m_islContext, string);
+    char *string = osl_relation_spprint_polylib(relation, names);
+    T *t = Func(context(), string);
     free(string);
     return t;
   }
 };
 
+/**
+ * @brief A memory-bounded LRU cache of enumerated points in front of another Enumerator.
+ * Entries are keyed by the structural hash of the relation and the projection dimensions.
+ * Parameter values are fixed by the context constraints of the relation, so they are part
+ * of the key.  Cache hits are verified with osl_relation_equal against a private copy of
+ * the relation.  Bounds are not cached and are always computed by the wrapped enumerator.
+ */
+class CachingEnumerator : public Enumerator {
+public:
+  /**
+   * @brief Construct a cache.
+   * @param [in] enumerator Enumerator computing the points on cache misses, ownership is transferred.
+   * @param [in] budget     Maximum number of bytes used by the cached points.
+   */
+  explicit CachingEnumerator(Enumerator *enumerator, size_t budget = DEFAULT_BUDGET);
+
+  PointBuffer enumerate(osl_relation_p relation, const std::vector<int> &dimensions) override;
+  std::vector<PointBuffer> enumerateMany(const std::vector<Request> &requests) override;
+  void forEachPoint(osl_relation_p relation, const std::vector<int> &dimensions,
+                    const PointVisitor &visitor) override;
+  std::vector<std::pair<int, int>> bounds(osl_relation_p relation, const std::vector<int> &dimensions) override;
+
+  ~CachingEnumerator() override;
+
+  size_t hits() const {
+    return m_cache.hits();
+  }
+
+  size_t misses() const {
+    return m_cache.misses();
+  }
+
+  /// Number of bytes currently used by the cached points.
+  size_t size() const {
+    return m_cache.size();
+  }
+
+  size_t budget() const {
+    return m_cache.budget();
+  }
+
+  void setBudget(size_t budget) {
+    m_cache.setBudget(budget);
+  }
+
+  void clear() {
+    m_cache.clear();
+  }
+
+  const static size_t DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+private:
+  struct Entry {
+    osl_relation_p relation;    ///< Owned copy.
+    std::vector<int> dimensions;
+    PointBuffer points;
+  };
+
+  bool find(size_t hash, osl_relation_p relation, const std::vector<int> &dimensions, PointBuffer &points);
+  void insert(size_t hash, osl_relation_p relation, const std::vector<int> &dimensions, const PointBuffer &points);
+
+  Enumerator *m_enumerator;
+  LRUCache<Entry> m_cache;
+};
+
 #endif // ENUMERATOR_H
@@ -0,0 +1,86 @@
+#include "legalitycache.h"
+#include "macros.h"
+#include "oslutils.h"
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+const size_t LegalityCache::DEFAULT_BUDGET;
+
+// Domain and scattering relations of all statements in order.
+static std::vector<osl_relation_p> scopRelations(osl_scop_p scop) {
+  std::vector<osl_relation_p> relations;
+  oslListForeach(scop->statement, [&relations](osl_statement_p stmt) {
+    relations.push_back(stmt->domain);
+    relations.push_back(stmt->scattering);
+  });
+  return std::move(relations);
+}
+
+LegalityCache::LegalityCache(size_t budget) :
+  m_cache(budget, [](Entry &entry) {
+    for (osl_relation_p relation : entry.relations) {
+      osl_relation_free(relation);
+    }
+  }) {
+}
+
+LegalityCache::~LegalityCache() {
+  clear();
+}
+
+size_t LegalityCache::scopHash(osl_scop_p original, osl_scop_p transformed) {
+  size_t seed = 0;
+  boost::hash_combine(seed, original);
+  for (osl_relation_p relation : scopRelations(transformed)) {
+    boost::hash_combine(seed, oslRelationHash(relation));
+  }
+  return seed;
+}
+
+bool LegalityCache::matches(const Entry &entry, osl_scop_p original, const std::vector<osl_relation_p> &relations) {
+  return entry.original == original && entry.relations.size() == relations.size() &&
+      std::equal(std::begin(relations), std::end(relations), std::begin(entry.relations),
+                 [](osl_relation_p r1, osl_relation_p r2) { return osl_relation_equal(r1, r2); });
+}
+
+bool LegalityCache::find(osl_scop_p original, osl_scop_p transformed,
+                         DependenceAnalyzer::DependenceMap &dependences) {
+  std::vector<osl_relation_p> relations = scopRelations(transformed);
+  return m_cache.find(scopHash(original, transformed), [original,&relations](const Entry &entry) {
+    return matches(entry, original, relations);
+  }, [&dependences](const Entry &entry) {
+    dependences = entry.dependences;
+  });
+}
+
+void LegalityCache::store(osl_scop_p original, osl_scop_p transformed,
+                          const DependenceAnalyzer::DependenceMap &dependences) {
+  std::vector<osl_relation_p> relations = scopRelations(transformed);
+  size_t bytes = dependences.size() * sizeof(DependenceAnalyzer::DependenceMap::value_type);
+  for (osl_relation_p relation : relations) {
+    bytes += oslRelationBytes(relation);
+  }
+
+  m_cache.insert(scopHash(original, transformed), bytes, [original,&relations](const Entry &entry) {
+    return matches(entry, original, relations);
+  }, [original,&relations,&dependences]() {
+    std::vector<osl_relation_p> copies;
+    for (osl_relation_p relation : relations) {
+      copies.push_back(osl_relation_clone(relation));
+    }
+    return Entry{original, std::move(copies), dependences};
+  });
+}
+
+void LegalityCache::remove(osl_scop_p original) {
+  m_cache.removeIf([original](const Entry &entry) {
+    return entry.original == original;
+  });
+}
+
+void LegalityCache::clear() {
+  m_cache.clear();
+}
@@ -0,0 +1,75 @@
+#ifndef LEGALITYCACHE_H
+#define LEGALITYCACHE_H
+
+#include <osl/osl.h>
+
+#include <vector>
+
+#include "dependenceanalyzer.h"
+#include "lrucache.h"
+
+/**
+ * @brief Dependences and violation flags of transformed scops that were already analyzed.
+ *
+ * Entries are keyed by the original scop and a structural hash of the domains and scattering
+ * relations of all statements of the transformed scop, which are the only parts of a scop Clay
+ * transformations change.  The same transformed scop, whichever sequence produced it, gets the
+ * result of the previous analysis without running Candl.  Hits are verified with
+ * osl_relation_equal against private copies of the relations.  The least recently used entries
+ * are evicted to stay within the memory budget.  The cache is shared between the GUI thread and
+ * the transformation workers, all calls are serialized by LRUCache.
+ *
+ * Entries own their copies of the relations, which are freed on eviction.  The osl dependences in
+ * the cached maps are not owned: ClintDependence objects built from a result keep pointing to them.
+ */
+class LegalityCache {
+public:
+  explicit LegalityCache(size_t budget = DEFAULT_BUDGET);
+  ~LegalityCache();
+
+  /// Put the dependences of @p transformed, obtained from @p original, to @p dependences if they are cached.
+  bool find(osl_scop_p original, osl_scop_p transformed, DependenceAnalyzer::DependenceMap &dependences);
+
+  void store(osl_scop_p original, osl_scop_p transformed, const DependenceAnalyzer::DependenceMap &dependences);
+
+  /// Drop all entries for @p original.
+  void remove(osl_scop_p original);
+  void clear();
+
+  size_t hits() const {
+    return m_cache.hits();
+  }
+
+  size_t misses() const {
+    return m_cache.misses();
+  }
+
+  /// Number of bytes currently used by the cached relations and dependence maps.
+  size_t size() const {
+    return m_cache.size();
+  }
+
+  size_t budget() const {
+    return m_cache.budget();
+  }
+
+  void setBudget(size_t budget) {
+    m_cache.setBudget(budget);
+  }
+
+  const static size_t DEFAULT_BUDGET = 8 * 1024 * 1024;
+
+private:
+  struct Entry {
+    osl_scop_p original;
+    std::vector<osl_relation_p> relations;          ///< Domain and scattering of each statement, owned.
+    DependenceAnalyzer::DependenceMap dependences;
+  };
+
+  static size_t scopHash(osl_scop_p original, osl_scop_p transformed);
+  static bool matches(const Entry &entry, osl_scop_p original, const std::vector<osl_relation_p> &relations);
+
+  LRUCache<Entry> m_cache;
+};
+
+#endif // LEGALITYCACHE_H
@@ -0,0 +1,162 @@
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @brief Memory-bounded store evicting the least recently used values first.
+ *
+ * Values are indexed by a hash and identified by a predicate, structural hashes of relations
+ * may collide.  Each value is accounted with the number of bytes given on insertion; values
+ * owning resources are freed by the release function when they are evicted or removed.  All
+ * calls are serialized by an internal mutex, so the store can be shared between threads.
+ */
+template <typename Value>
+class LRUCache {
+public:
+  typedef std::function<void (Value &)> Release;
+
+  explicit LRUCache(size_t budget, Release release = Release()) :
+    m_budget(budget), m_release(std::move(release)) {
+  }
+
+  ~LRUCache() {
+    clear();
+  }
+
+  LRUCache(const LRUCache &) = delete;
+  LRUCache &operator =(const LRUCache &) = delete;
+
+  /// Call @p use on the value with @p hash for which @p matches is true and mark it recently used.
+  template <typename Matches, typename Use>
+  bool find(size_t hash, Matches matches, Use use) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    typename EntryList::iterator entry = lookup(hash, matches);
+    if (entry == m_entries.end()) {
+      ++m_misses;
+      return false;
+    }
+    ++m_hits;
+    use(static_cast<const Value &>(entry->value));
+    return true;
+  }
+
+  /// Store the value returned by @p make unless it exceeds the budget or a matching value is already stored.
+  template <typename Matches, typename Make>
+  void insert(size_t hash, size_t bytes, Matches matches, Make make) {
+    bytes += sizeof(Entry);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (bytes > m_budget)
+      return;
+    if (lookup(hash, matches) != m_entries.end())
+      return;
+
+    evict(m_budget - bytes);
+    m_entries.push_front(Entry{hash, bytes, make()});
+    m_index.emplace(hash, m_entries.begin());
+    m_size += bytes;
+  }
+
+  /// Drop all values for which @p predicate is true.
+  template <typename Predicate>
+  void removeIf(Predicate predicate) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (typename EntryList::iterator it = m_entries.begin(); it != m_entries.end(); ) {
+      typename EntryList::iterator entry = it++;
+      if (predicate(static_cast<const Value &>(entry->value)))
+        erase(entry);
+    }
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    evict(0);
+  }
+
+  void setBudget(size_t budget) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = budget;
+    evict(m_budget);
+  }
+
+  size_t budget() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budget;
+  }
+
+  /// Number of bytes currently accounted for the stored values.
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+  }
+
+  size_t hits() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+  }
+
+  size_t misses() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+  }
+
+private:
+  struct Entry {
+    size_t hash;
+    size_t bytes;
+    Value value;
+  };
+  typedef std::list<Entry> EntryList;
+
+  template <typename Matches>
+  typename EntryList::iterator lookup(size_t hash, Matches &matches) {
+    auto range = m_index.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      typename EntryList::iterator entry = it->second;
+      if (matches(static_cast<const Value &>(entry->value))) {
+        m_entries.splice(m_entries.begin(), m_entries, entry);
+        return entry;
+      }
+    }
+    return m_entries.end();
+  }
+
+  void erase(typename EntryList::iterator entry) {
+    auto range = m_index.equal_range(entry->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == entry) {
+        m_index.erase(it);
+        break;
+      }
+    }
+    m_size -= entry->bytes;
+    if (m_release)
+      m_release(entry->value);
+    m_entries.erase(entry);
+  }
+
+  void evict(size_t budget) {
+    while (m_size > budget && !m_entries.empty()) {
+      erase(std::prev(m_entries.end()));
+    }
+  }
+
+  size_t m_budget;
+  size_t m_size   = 0;
+  size_t m_hits   = 0;
+  size_t m_misses = 0;
+  Release m_release;
+
+  // Most recently used entries first.
+  EntryList m_entries;
+  std::unordered_multimap<size_t, typename EntryList::iterator> m_index;
+  mutable std::mutex m_mutex;
+};
+
+#endif // LRUCACHE_H
@@ -4,9 +4,18 @@
 #include "clintbeta.h"
 #include "clintwindow.h"
 
+#include "codegenerator.h"
+#include "dependenceanalyzer.h"
 #include "enumerator.h"
 #include "oslutils.h"
+#include "transformer.h"
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <unordered_set>
 
 namespace {
 
@@ -32,9 +41,9 @@ void enumerationTest() {
     LL_FOREACH(ready_part, ready) {
       osl_relation_p keeper = ready_part->next;
       ready_part->next = nullptr;
-      auto points = enumerator->enumerate(ready_part, dims);
+      PointBuffer points = enumerator->enumerate(ready_part, dims);
       ready_part->next = keeper;
-      std::for_each(std::begin(points), std::end(points), [](std::vector<int> &p){
+      std::for_each(std::begin(points), std::end(points), [](PointBuffer::Row p){
         std::copy(std::begin(p), std::end(p), std::ostream_iterator<int>(std::cout, ", "));
         std::cout << std::endl;
       });
@@ -43,6 +52,367 @@ void enumerationTest() {
   delete enumerator;
 }
 
+void conversionBenchmark() {
+  const int nbRepetitions = 1000;
+  FILE *file = fopen("enumeration.scop", "r");
+  assert(file);
+  osl_scop_p scop = osl_scop_read(file);
+  fclose(file);
+
+  std::vector<osl_relation_p> relations;
+  osl_statement_p statement;
+  LL_FOREACH(statement, scop->statement) {
+    relations.push_back(oslApplyScattering(statement));
+  }
+
+  typedef std::chrono::high_resolution_clock Clock;
+  auto measure = [&relations,nbRepetitions](std::function<isl_set *(osl_relation_p)> toISL,
+                                            std::function<osl_relation_p (isl_set *)> toOSL) {
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < nbRepetitions; i++) {
+      for (osl_relation_p relation : relations) {
+        isl_set *set = toISL(relation);
+        osl_relation_p back = toOSL(set);
+        isl_set_free(set);
+        osl_relation_free(back);
+      }
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+  };
+
+  // Both paths must describe the same sets.
+  for (osl_relation_p relation : relations) {
+    isl_set *direct = ISLEnumerator::setFromOSLRelation(relation);
+    isl_set *text = ISLEnumerator::setFromOSLRelationText(relation);
+    assert(isl_set_is_equal(direct, text) == isl_bool_true);
+    osl_relation_p back = ISLEnumerator::setToOSLRelation(direct);
+    isl_set *roundtrip = ISLEnumerator::setFromOSLRelation(back);
+    assert(isl_set_is_equal(direct, roundtrip) == isl_bool_true);
+    osl_relation_free(back);
+    isl_set_free(roundtrip);
+    isl_set_free(text);
+    isl_set_free(direct);
+  }
+
+  long long textTime = measure([](osl_relation_p r) { return ISLEnumerator::setFromOSLRelationText(r); },
+                              [](isl_set *s) { return ISLEnumerator::setToOSLRelationText(s); });
+  long long directTime = measure([](osl_relation_p r) { return ISLEnumerator::setFromOSLRelation(r); },
+                                [](isl_set *s) { return ISLEnumerator::setToOSLRelation(s); });
+  std::cout << relations.size() << " relations x " << nbRepetitions << " round-trips" << std::endl
+            << "string:  " << textTime << " us" << std::endl
+            << "direct:  " << directTime << " us" << std::endl;
+
+  for (osl_relation_p relation : relations) {
+    osl_relation_free(relation);
+  }
+  osl_scop_free(scop);
+}
+
+void enumerationCacheBenchmark() {
+  const int nbRepetitions = 10;
+  FILE *file = fopen("enumeration.scop", "r");
+  assert(file);
+  osl_scop_p scop = osl_scop_read(file);
+  fclose(file);
+
+  std::vector<Enumerator::Request> requests;
+  osl_statement_p statement;
+  LL_FOREACH(statement, scop->statement) {
+    osl_relation_p relation = oslApplyScattering(statement);
+    osl_relation_p ready = oslRelationsWithContext(relation, scop->context);
+    osl_relation_free(relation);
+    std::vector<int> dims;
+    for (int i = 0; i < ready->nb_output_dims; i++) {
+      dims.push_back(i);
+    }
+    osl_relation_p ready_part;
+    LL_FOREACH(ready_part, ready) {
+      requests.push_back(Enumerator::Request{osl_relation_nclone(ready_part, 1), dims});
+    }
+    osl_relation_free(ready);
+  }
+
+  typedef std::chrono::high_resolution_clock Clock;
+  CachingEnumerator cache(new ISLEnumerator);
+  Clock::time_point start = Clock::now();
+  cache.enumerateMany(requests);
+  Clock::time_point middle = Clock::now();
+  for (int i = 0; i < nbRepetitions; i++) {
+    cache.enumerateMany(requests);
+  }
+  Clock::time_point end = Clock::now();
+  std::cout << requests.size() << " relations" << std::endl
+            << "cold:    " << std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count()
+            << " us" << std::endl
+            << "cached:  " << std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count() / nbRepetitions
+            << " us" << std::endl
+            << cache.hits() << " hits, " << cache.misses() << " misses, "
+            << cache.size() << " bytes cached" << std::endl;
+
+  for (const Enumerator::Request &request : requests) {
+    osl_relation_free(request.relation);
+  }
+  osl_scop_free(scop);
+}
+
+// Sequence of nbStatements perfect loop nests of the given depth.
+osl_scop_p syntheticScop(int nbStatements, int depth) {
+  std::stringstream code;
+  code << "#pragma scop\n";
+  for (int s = 0; s < nbStatements; s++) {
+    std::string subscripts;
+    for (int d = 0; d < depth; d++) {
+      code << std::string(d * 2, ' ') << "for (i" << d << " = 0; i" << d << " < N; i" << d << "++)\n";
+      subscripts += "[i" + std::to_string(d) + "]";
+    }
+    code << std::string(depth * 2, ' ') << "A" << s << subscripts << " = A" << s << subscripts << " + 1;\n";
+  }
+  code << "#pragma endscop\n";
+  std::string source = code.str();
+  osl_scop_p scop = oslFromCCode(&source[0]);
+  assert(scop);
+  return scop;
+}
+
+// Group tiling every loop of the synthetic scop, innermost loops first so that the depths of outer
+// loops do not change.
+TransformationGroup syntheticTilingGroup(int nbStatements, int depth, int tileSize) {
+  TransformationGroup group;
+  for (int s = 0; s < nbStatements; s++) {
+    for (int d = depth; d > 0; d--) {
+      std::vector<int> beta(d, 0);
+      beta[0] = s;
+      group.transformations.push_back(Transformation::tile(beta, d, tileSize));
+    }
+  }
+  return group;
+}
+
+osl_scop_p syntheticTiledScop(int nbStatements, int depth, int tileSize) {
+  osl_scop_p scop = syntheticScop(nbStatements, depth);
+  ClayTransformer transformer;
+  transformer.apply(scop, syntheticTilingGroup(nbStatements, depth, tileSize));
+  return scop;
+}
+
+// Groups like those VizManipulationManager creates when splitting and tiling loops with many statements.
+void normalizationBenchmark() {
+  const int nbRepetitions = 20;
+  typedef std::chrono::high_resolution_clock Clock;
+
+  for (int nbStatements : {4, 16, 32}) {
+    const int depth = 3;
+    osl_scop_p scop = syntheticScop(nbStatements, depth);
+
+    TransformationGroup group;
+    for (int s = 0; s < nbStatements; s++) {
+      // Split the outer loop at i0 = 16: 1*i0 + 0*i1 + 0*i2 + 0*N - 16 >= 0.
+      std::vector<int> constraint(1 + depth + 1 + 1, 0);
+      constraint[0] = 1;
+      constraint[1] = 1;
+      constraint.back() = -16;
+      group.transformations.push_back(Transformation::issFromConstraint({s}, constraint, depth));
+    }
+    for (const Transformation &transformation : syntheticTilingGroup(nbStatements, depth, 8).transformations) {
+      group.transformations.push_back(transformation);
+    }
+
+    auto measure = [scop,&group,nbRepetitions](bool deferred, osl_scop_p &result) {
+      ClayTransformer transformer;
+      transformer.setDeferredNormalization(deferred);
+      long long time = 0;
+      for (int i = 0; i < nbRepetitions; i++) {
+        osl_scop_p transformed = osl_scop_clone(scop);
+        Clock::time_point start = Clock::now();
+        transformer.apply(transformed, group);
+        time += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        if (result)
+          osl_scop_free(result);
+        result = transformed;
+      }
+      return time / nbRepetitions;
+    };
+
+    osl_scop_p eager = nullptr, deferred = nullptr;
+    try {
+      long long eagerTime = measure(false, eager);
+      long long deferredTime = measure(true, deferred);
+      std::cout << nbStatements << " statements, " << group.transformations.size() << " transformations" << std::endl
+                << "  per transformation: " << eagerTime << " us" << std::endl
+                << "  per group:          " << deferredTime << " us" << std::endl
+                << "  same result:        " << (osl_scop_equal(eager, deferred) ? "yes" : "no") << std::endl;
+    } catch (std::exception &e) {
+      std::cout << nbStatements << " statements: " << e.what() << std::endl;
+    }
+    if (eager)
+      osl_scop_free(eager);
+    if (deferred)
+      osl_scop_free(deferred);
+    osl_scop_free(scop);
+  }
+}
+
+void codeGenerationBenchmark() {
+  const int nbRepetitions = 10;
+  std::vector<std::pair<std::string, osl_scop_p>> scops;
+  QDir examples("examples");
+  for (const QString &fileName : examples.entryList(QStringList() << "*.scop", QDir::Files)) {
+    FILE *file = fopen(examples.filePath(fileName).toLocal8Bit().constData(), "r");
+    if (!file)
+      continue;
+    scops.emplace_back(fileName.toStdString(), osl_scop_read(file));
+    fclose(file);
+  }
+  for (int depth : {2, 3, 4}) {
+    int nbStatements = 8;
+    scops.emplace_back("synthetic " + std::to_string(nbStatements) + "x" + std::to_string(depth) + " tiled",
+                       syntheticTiledScop(nbStatements, depth, 32));
+  }
+
+  typedef std::chrono::high_resolution_clock Clock;
+  for (auto &named : scops) {
+    std::cout << named.first << std::endl;
+    for (CodeGenerator::Backend backend : {CodeGenerator::Backend::CLooG, CodeGenerator::Backend::ISL}) {
+      std::unique_ptr<CodeGenerator> generator(CodeGenerator::create(backend));
+      size_t codeLength = 0, nbPositions = 0;
+      Clock::time_point start = Clock::now();
+      for (int i = 0; i < nbRepetitions; i++) {
+        CodeGenerator::PositionMap positions;
+        char *code = generator->generate(named.second, positions);
+        codeLength = strlen(code);
+        nbPositions = positions.size();
+        free(code);
+      }
+      long long time = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+      std::cout << "  " << CodeGenerator::backendName(backend) << ": "
+                << time / nbRepetitions << " us, "
+                << codeLength << " chars, "
+                << nbPositions << " statements" << std::endl;
+    }
+    osl_scop_free(named.second);
+  }
+}
+
+// Dependences of the examples and legality of reversing their first loop, with both analyzers.
+void dependenceBenchmark() {
+  const int nbRepetitions = 10;
+  typedef std::chrono::high_resolution_clock Clock;
+  QDir examples("examples");
+  for (const QString &fileName : examples.entryList(QStringList() << "*.scop", QDir::Files)) {
+    FILE *file = fopen(examples.filePath(fileName).toLocal8Bit().constData(), "r");
+    if (!file)
+      continue;
+    osl_scop_p scop = osl_scop_read(file);
+    fclose(file);
+
+    osl_scop_p reversed = osl_scop_clone(scop);
+    try {
+      ClayTransformer transformer;
+      transformer.apply(reversed, Transformation::reverse({0}, 1));
+    } catch (std::exception &) {
+      osl_scop_free(reversed);
+      reversed = osl_scop_clone(scop);
+    }
+
+    std::cout << fileName.toStdString() << std::endl;
+    for (DependenceAnalyzer::Backend backend : {DependenceAnalyzer::Backend::Candl, DependenceAnalyzer::Backend::ISL}) {
+      std::unique_ptr<DependenceAnalyzer> analyzer(DependenceAnalyzer::create(backend));
+      size_t nbDependences = 0, nbViolated = 0;
+      Clock::time_point start = Clock::now();
+      for (int i = 0; i < nbRepetitions; i++) {
+        nbDependences = analyzer->analyze(scop).size();
+      }
+      Clock::time_point middle = Clock::now();
+      for (int i = 0; i < nbRepetitions; i++) {
+        DependenceAnalyzer::DependenceMap dependences = analyzer->analyze(scop, reversed);
+        nbViolated = std::count_if(dependences.begin(), dependences.end(),
+                                   [](const DependenceAnalyzer::DependenceMap::value_type &v) {
+          return v.second.second;
+        });
+      }
+      Clock::time_point end = Clock::now();
+      std::cout << "  " << DependenceAnalyzer::backendName(backend) << ": "
+                << std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count() / nbRepetitions
+                << " us, " << nbDependences << " dependences; legality "
+                << std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count() / nbRepetitions
+                << " us, " << nbViolated << " violated" << std::endl;
+    }
+    osl_scop_free(reversed);
+    osl_scop_free(scop);
+  }
+}
+
+// Incremental reanalysis from the original schedule must flag the same violations as a full analysis.
+void reanalysisTest() {
+  QDir examples("examples");
+  int nbChecked = 0, nbMismatches = 0;
+  for (const QString &fileName : examples.entryList(QStringList() << "*.scop", QDir::Files)) {
+    FILE *file = fopen(examples.filePath(fileName).toLocal8Bit().constData(), "r");
+    if (!file)
+      continue;
+    osl_scop_p scop = osl_scop_read(file);
+    fclose(file);
+    if (scop == nullptr || scop->statement == nullptr) {
+      osl_scop_free(scop);
+      continue;
+    }
+
+    // The whole first loop and only the innermost loop of the first statement.
+    std::vector<int> firstBeta = betaExtract(scop->statement->scattering);
+    std::vector<Transformation> transformations {
+      Transformation::reverse({0}, 1),
+      Transformation::constantShift({0}, 1, 2)
+    };
+    if (firstBeta.size() > 1) {
+      transformations.push_back(Transformation::reverse(firstBeta, firstBeta.size() - 1));
+    }
+
+    for (const Transformation &transformation : transformations) {
+      osl_scop_p transformed = osl_scop_clone(scop);
+      try {
+        ClayTransformer transformer;
+        transformer.apply(transformed, transformation);
+      } catch (std::exception &) {
+        osl_scop_free(transformed);
+        continue;
+      }
+
+      for (DependenceAnalyzer::Backend backend : {DependenceAnalyzer::Backend::Candl, DependenceAnalyzer::Backend::ISL}) {
+        std::unique_ptr<DependenceAnalyzer> analyzer(DependenceAnalyzer::create(backend));
+        DependenceAnalyzer::DependenceMap full = analyzer->analyze(scop, transformed);
+        DependenceAnalyzer::DependenceMap incremental =
+            analyzer->reanalyze(scop, transformed, scop, analyzer->analyze(scop));
+        assert(full.size() == incremental.size());
+
+        // Analyses create distinct osl dependences, match them by occurrences, type and domain.
+        std::unordered_set<osl_dependence_p> matched;
+        for (const DependenceAnalyzer::DependenceMap::value_type &element : full) {
+          auto range = incremental.equal_range(element.first);
+          auto found = std::find_if(range.first, range.second,
+                                    [&element,&matched](const DependenceAnalyzer::DependenceMap::value_type &other) {
+            return matched.count(other.second.first) == 0 &&
+                other.second.first->type == element.second.first->type &&
+                osl_relation_equal(other.second.first->domain, element.second.first->domain);
+          });
+          assert(found != range.second);
+          matched.insert(found->second.first);
+          ++nbChecked;
+          if (found->second.second != element.second.second) {
+            ++nbMismatches;
+            std::cout << fileName.toStdString() << ": " << DependenceAnalyzer::backendName(backend)
+                      << " reanalysis flags a dependence " << (found->second.second ? "violated" : "legal")
+                      << ", full analysis " << (element.second.second ? "violated" : "legal") << std::endl;
+          }
+        }
+      }
+      osl_scop_free(transformed);
+    }
+    osl_scop_free(scop);
+  }
+  std::cout << nbChecked << " dependences checked, " << nbMismatches << " mismatches" << std::endl;
+  assert(nbMismatches == 0);
+}
+
 } // end anonymous namespace
 
 int main(int argc, char **argv) {
@@ -50,6 +420,12 @@ int main(int argc, char **argv) {
   qRegisterMetaType<ClintBeta>();
 
   QApplication app(argc, argv);
+  if (app.arguments().contains("--codegen=isl")) {
+    CodeGenerator::setBackend(CodeGenerator::Backend::ISL);
+  }
+  if (app.arguments().contains("--dependences=isl")) {
+    DependenceAnalyzer::setBackend(DependenceAnalyzer::Backend::ISL);
+  }
   ClintWindow window;
   window.showMaximized();
 
@@ -57,6 +433,30 @@ int main(int argc, char **argv) {
     enumerationTest();
     return 0;
   }
+  if (app.arguments().contains("--test=reanalysis")) {
+    reanalysisTest();
+    return 0;
+  }
+  if (app.arguments().contains("--benchmark=enumeration")) {
+    enumerationCacheBenchmark();
+    return 0;
+  }
+  if (app.arguments().contains("--benchmark=conversion")) {
+    conversionBenchmark();
+    return 0;
+  }
+  if (app.arguments().contains("--benchmark=codegen")) {
+    codeGenerationBenchmark();
+    return 0;
+  }
+  if (app.arguments().contains("--benchmark=normalization")) {
+    normalizationBenchmark();
+    return 0;
+  }
+  if (app.arguments().contains("--benchmark=dependences")) {
+    dependenceBenchmark();
+    return 0;
+  }
 
   return app.exec();
 }
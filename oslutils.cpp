@@ -1,4 +1,5 @@
 #include "oslutils.h"
+#include "codegenerator.h"
 #include "macros.h"
 
 #include <osl/osl.h>
@@ -7,7 +8,14 @@
 #include <clay/clay.h>
 #include <clay/beta.h>
 
+#include <boost/functional/hash.hpp>
+
 #include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
 #include <vector>
 #include <functional>
 #include <utility>
@@ -149,6 +157,26 @@ osl_relation_p oslRelationWithContext(osl_relation_p relation, osl_relation_p co
   return result;
 }
 
+osl_relation_p oslRelationWithBounds(osl_relation_p relation, int dimension, int lowerBound, int upperBound) {
+  CLINT_ASSERT(dimension >= 0 &&
+               dimension < relation->nb_output_dims + relation->nb_input_dims + relation->nb_local_dims,
+               "Bounded dimension does not exist");
+  osl_relation_p result = osl_relation_nclone(relation, 1);
+
+  // dimension - lowerBound >= 0
+  osl_relation_insert_blank_row(result, -1);
+  osl_int_set_si(result->precision, &result->m[result->nb_rows - 1][0], 1);
+  osl_int_set_si(result->precision, &result->m[result->nb_rows - 1][1 + dimension], 1);
+  osl_int_set_si(result->precision, &result->m[result->nb_rows - 1][result->nb_columns - 1], -lowerBound);
+
+  // -dimension + upperBound >= 0
+  osl_relation_insert_blank_row(result, -1);
+  osl_int_set_si(result->precision, &result->m[result->nb_rows - 1][0], 1);
+  osl_int_set_si(result->precision, &result->m[result->nb_rows - 1][1 + dimension], -1);
+  osl_int_set_si(result->precision, &result->m[result->nb_rows - 1][result->nb_columns - 1], upperBound);
+  return result;
+}
+
 osl_relation_p oslRelationFixParameters(osl_relation_p relation, const std::vector<std::pair<bool, int>> &values) {
   if (relation == nullptr) {
     return nullptr;
@@ -231,6 +259,33 @@ int oslRelationDimLowerBound(osl_relation_p relation, int dimension) {
   return oslRelationDimBoundHelper(relation, dimension, 1);
 }
 
+size_t oslRelationBytes(osl_relation_p relation) {
+  size_t bytes = 0;
+  oslListForeach(relation, [&bytes](osl_relation_p r) {
+    bytes += sizeof(*r) + r->nb_rows * (sizeof(osl_int_t *) + r->nb_columns * sizeof(osl_int_t));
+  });
+  return bytes;
+}
+
+size_t oslRelationHash(osl_relation_p relation) {
+  size_t seed = 0;
+  for (osl_relation_p part = relation; part != nullptr; part = part->next) {
+    boost::hash_combine(seed, part->type);
+    boost::hash_combine(seed, part->nb_rows);
+    boost::hash_combine(seed, part->nb_columns);
+    boost::hash_combine(seed, part->nb_output_dims);
+    boost::hash_combine(seed, part->nb_input_dims);
+    boost::hash_combine(seed, part->nb_local_dims);
+    boost::hash_combine(seed, part->nb_parameters);
+    for (int i = 0; i < part->nb_rows; i++) {
+      for (int j = 0; j < part->nb_columns; j++) {
+        boost::hash_combine(seed, osl_int_get_si(part->precision, part->m[i][j]));
+      }
+    }
+  }
+  return seed;
+}
+
 std::vector<int> betaFromClay(clay_array_p beta) {
   std::vector<int> betavector;
   betavector.reserve(beta->size);
@@ -257,11 +312,17 @@ osl_scop_p oslFromCCode(FILE *file) {
   return clan_scop;
 }
 
+// Read-only stream over the string, which must outlive the stream.
+static FILE *stringStream(std::string &contents) {
+  FILE *file = fmemopen(&contents[0], contents.size(), "r");
+  CLINT_ASSERT(file != nullptr, "Could not open an in-memory stream");
+  return file;
+}
+
 osl_scop_p oslFromCCode(char *code) {
-  FILE *file = tmpfile();
-  fprintf(file, "%s", code);
-  fflush(file);
-  rewind(file);
+  // Terminate with a newline so that the stream is never empty.
+  std::string contents = std::string(code) + "\n";
+  FILE *file = stringStream(contents);
   osl_scop_p clan_scop = oslFromCCode(file);
   fclose(file);
   return clan_scop;
@@ -281,34 +342,106 @@ char *fileContents(FILE *f) {
   return cstr;
 }
 
+osl_scop_p oslReifyBetas(osl_scop_p scop, std::vector<std::vector<int>> &betas) {
+  // Clone everything but the statements, they are cloned one scattering relation at a time.
+  osl_statement_p statements = scop->statement;
+  scop->statement = nullptr;
+  osl_scop_p reified = osl_scop_clone(scop);
+  scop->statement = statements;
+
+  osl_statement_p *tail = &reified->statement;
+  oslListForeach(statements, [&tail,&betas](osl_statement_p stmt) {
+    oslListForeachSingle(stmt->scattering, [&tail,&betas,stmt](osl_relation_p scattering) {
+      osl_statement_p part = osl_statement_nclone(stmt, 1);
+      osl_relation_free(part->scattering);
+      part->scattering = osl_relation_nclone(scattering, 1);
+      betas.push_back(betaExtract(scattering));
+      *tail = part;
+      tail = &part->next;
+    });
+  });
+  return reified;
+}
+
+std::vector<std::string> oslParameterNames(osl_scop_p scop) {
+  osl_strings_p names = scop->parameters != nullptr ?
+        (osl_strings_p) osl_generic_lookup(scop->parameters, OSL_URI_STRINGS) : nullptr;
+  int nbParameters = scop->context != nullptr ? scop->context->nb_parameters : 0;
+  std::vector<std::string> result;
+  for (int i = 0; i < nbParameters; i++) {
+    if (names != nullptr && i < static_cast<int>(osl_strings_size(names)))
+      result.push_back(names->string[i]);
+    else
+      result.push_back("P" + std::to_string(i + 1));
+  }
+  return std::move(result);
+}
+
+std::string oslStatementCode(osl_statement_p stmt, int number, const std::vector<std::string> &substitutions) {
+  osl_body_p body = nullptr;
+  osl_extbody_p extbody = (osl_extbody_p) osl_generic_lookup(stmt->extension, OSL_URI_EXTBODY);
+  if (extbody)
+    body = extbody->body;
+  else
+    body = (osl_body_p) osl_generic_lookup(stmt->extension, OSL_URI_BODY);
+
+  std::string code;
+  if (!body || !body->expression || !body->expression->string[0]) {
+    code += "S" + std::to_string(number) + "(";
+    for (size_t i = 0; i < substitutions.size(); i++) {
+      if (i != 0)
+        code += ",";
+      code += substitutions[i];
+    }
+    code += ");";
+    return std::move(code);
+  }
+
+  // Copy the body replacing every identifier that names an original iterator.
+  size_t nbIterators = body->iterators ? osl_strings_size(body->iterators) : 0;
+  const char *current = body->expression->string[0];
+  while (*current) {
+    if (isdigit(*current)) {
+      // Numeric literals may contain letters, e.g. 1e5 or 0x1f, that are not identifiers.
+      const char *end = current;
+      while (isalnum(*end) || *end == '_' || *end == '.')
+        ++end;
+      code.append(current, end);
+      current = end;
+      continue;
+    }
+    if (!isalpha(*current) && *current != '_') {
+      code += *current++;
+      continue;
+    }
+
+    const char *end = current;
+    while (isalnum(*end) || *end == '_')
+      ++end;
+    size_t length = end - current;
+    size_t iterator = 0;
+    for ( ; iterator < nbIterators; iterator++) {
+      if (strlen(body->iterators->string[iterator]) == length &&
+          strncmp(body->iterators->string[iterator], current, length) == 0)
+        break;
+    }
+    if (iterator < nbIterators && iterator < substitutions.size())
+      code += substitutions[iterator];
+    else
+      code.append(current, end);
+    current = end;
+  }
+  return std::move(code);
+}
+
+char *oslToCCode(osl_scop_p scop, std::multimap<std::vector<int>, std::pair<int, int>> &positions) {
+  std::unique_ptr<CodeGenerator> generator(CodeGenerator::create(CodeGenerator::backend()));
+  return generator->generate(scop, positions);
+}
+
 char *oslToCCode(osl_scop_p scop) {
-  CloogState *state = cloog_state_malloc();
-  CloogOptions *options = cloog_options_malloc(state);
-  options->openscop = 1;
-  options->quiet = 1;
-//  options->scop = scop;
-//  CloogProgram *program = cloog_program_malloc();
-
-  FILE *tmpOslFile = tmpfile();
-  osl_scop_print(tmpOslFile, scop);
-  fflush(tmpOslFile);
-  rewind(tmpOslFile);
-  CloogProgram *program = cloog_program_read(tmpOslFile, options);
-  fclose(tmpOslFile);
-
-  program = cloog_program_generate(program, options);
-  FILE *tmpCloogFile = tmpfile();
-  cloog_program_pprint(tmpCloogFile, program, options);
-  fflush(tmpCloogFile);
-
-  char *str = fileContents(tmpCloogFile);
-
-  fclose(tmpCloogFile);
-  cloog_program_free(program);
-  cloog_options_free(options);
-  cloog_state_free(state);
-
-  return str;
+  std::multimap<std::vector<int>, std::pair<int, int>> positions;
+  return oslToCCode(scop, positions);
 }
 
 #include <QString>
@@ -337,91 +470,6 @@ char *escapeHtml(char *str) {
   return strdup(s.toStdString().c_str());
 }
 
-// TODO: this function assumes that one beta may have multiple positions in the code,
-// but one statement cannot have multiple betas (which is false in case of iss)
-// We cannot solve this without support from CLooG since we cannot generate different
-// statement contents for different betas of the same statement.
-//
-// Actually, we can!  All betas in the inputScop may be reified to a statement.
-// On the other hand, we do not know how this may affect the output code.  Having CLooG
-// generate information about statement position in the code is a better solution.
-std::multimap<std::vector<int>, std::pair<int, int>> stmtPositionsInHelper(osl_scop_p inputScop, bool isHtml) {
-  std::multimap<std::vector<int>, std::pair<int, int>> positions;
-
-  osl_scop_p scop = osl_scop_clone(inputScop);
-
-  int counter = 0;
-  char buffer[40];
-  oslListForeach(scop->statement, [&counter,&buffer](osl_statement_p stmt) {
-    snprintf(buffer, sizeof(buffer), "__clintstmt__%05d", counter++);
-    osl_extbody_p extbody = (osl_extbody_p) osl_generic_lookup(stmt->extension, OSL_URI_EXTBODY);
-    if (extbody) {
-      osl_body_p body = extbody->body;
-      osl_strings_free(body->expression);
-      body->expression = osl_strings_encapsulate(strdup(buffer));
-    }
-    osl_body_p body = (osl_body_p) osl_generic_lookup(stmt->extension, OSL_URI_BODY);
-    if (body) {
-      osl_strings_free(body->expression);
-      body->expression = osl_strings_encapsulate(strdup(buffer));
-    }
-  });
-
-
-  char *generatedCode, *originalCode;
-  if (isHtml) {
-    char *generatedRawCode = oslToCCode(scop);
-    char *originalRawCode = oslToCCode(inputScop);
-    generatedCode = escapeHtml(generatedRawCode);
-    originalCode = escapeHtml(originalRawCode);
-    free(generatedRawCode);
-    free(originalRawCode);
-  } else {
-    generatedCode = oslToCCode(scop);
-    originalCode = oslToCCode(inputScop);
-  }
-
-  char *current = generatedCode;
-  char intBuffer[6];
-  intBuffer[5] = '\0';
-  int lengthDifference = 0;
-  while (true) {
-    char *found = strstr(current, "__clintstmt__");
-    if (!found)
-      break;
-    strncpy(intBuffer, found + strlen("__clintstmt__"), 5);
-    int stmtIdx = atoi(intBuffer);
-    osl_statement_p stmt = oslListAt(scop->statement, stmtIdx);
-    if (!stmt)
-      break;
-    std::vector<int> beta = betaExtract(stmt->scattering); // FIXME: multiple scatterings possible
-    long generatedStmtStartPos = (found - generatedCode);
-    long originalStmtStartPos = generatedStmtStartPos + lengthDifference;
-    char *end = strstr(originalCode + originalStmtStartPos, ";");
-
-    if (end == nullptr)
-      break;
-    long generatedStmtEndPos = generatedStmtStartPos + strlen("__clintstmt__00000");
-    long originalStmtEndPos = (end - originalCode) + 1; // Take ';' into account as well
-    lengthDifference += (originalStmtEndPos - originalStmtStartPos) - (generatedStmtEndPos - generatedStmtStartPos);
-    positions.emplace(beta, std::make_pair(originalStmtStartPos, originalStmtEndPos));
-    current = found + (generatedStmtEndPos - generatedStmtEndPos) + 1;
-  }
-
-  free(generatedCode);
-  free(originalCode);
-
-  return std::move(positions);
-}
-
-std::multimap<std::vector<int>, std::pair<int, int>> stmtPositionsInHtml(osl_scop_p inputScop) {
-  return stmtPositionsInHelper(inputScop, true);
-}
-
-std::multimap<std::vector<int>, std::pair<int, int>> stmtPositionsInCode(osl_scop_p inputScop) {
-  return stmtPositionsInHelper(inputScop, false);
-}
-
 template <typename T>
 void oslListOnlyElement(T **container, int index) {
   if (index < 0 || container == nullptr || *container == nullptr)
@@ -522,9 +570,8 @@ osl_scop_p oslReifyScop(osl_scop_p scop) {
   // statements -- this will not result in beta-vector collisions.
 
 osl_scop_p parseCode(char *code) {
-  FILE *file = tmpfile();
-  fprintf(file, "%s\n", code);
-  rewind(file);
+  std::string contents = std::string(code) + "\n";
+  FILE *file = stringStream(contents);
   clan_options_p options = clan_options_malloc();
   options->castle = 0;
   options->extbody = 1;
@@ -12,6 +12,7 @@
 
 #include <functional>
 #include <map>
+#include <string>
 #include <tuple>
 #include <utility>
 
@@ -186,6 +187,20 @@ inline osl_relation_p oslRelationsWithContext(osl_relation_p relation, osl_relat
   return oslListTransform(relation, &oslRelationWithContext, context);
 }
 
+/// Structural hash of a relation union: dimensions and constraint matrices of all parts.
+/// Relations equal in the sense of osl_relation_equal have equal hashes.
+size_t oslRelationHash(osl_relation_p relation);
+
+/// Approximate number of bytes used by a relation union.
+size_t oslRelationBytes(osl_relation_p relation);
+
+/// Restrict the dimension (0-based, output dimensions first) to [lowerBound, upperBound].
+osl_relation_p oslRelationWithBounds(osl_relation_p relation, int dimension, int lowerBound, int upperBound);
+
+inline osl_relation_p oslRelationsWithBounds(osl_relation_p relation, int dimension, int lowerBound, int upperBound) {
+  return oslListTransform(relation, &oslRelationWithBounds, dimension, lowerBound, upperBound);
+}
+
 int oslRelationDimUpperBound(osl_relation_p relation, int dimension);
 int oslRelationDimLowerBound(osl_relation_p relation, int dimension);
 
@@ -209,12 +224,24 @@ inline std::vector<int> betaExtract(osl_relation_p relation) {
 
 osl_scop_p oslFromCCode(FILE *file);
 osl_scop_p oslFromCCode(char *code);
+/// Split statements with multiple scattering relations into statements with one relation each.
+/// The beta-vector of every statement of the returned scop is appended to @p betas.
+osl_scop_p oslReifyBetas(osl_scop_p scop, std::vector<std::vector<int>> &betas);
+
+/// Names of the parameters of @p scop, generated as P1, P2, ... if the scop does not define them.
+std::vector<std::string> oslParameterNames(osl_scop_p scop);
+
+/// Body of @p stmt with the original iterators replaced by @p substitutions, or a macro call S<number>(...)
+/// if the statement has no body.
+std::string oslStatementCode(osl_statement_p stmt, int number, const std::vector<std::string> &substitutions);
+
+/// Generate code with the backend selected by CodeGenerator::setBackend.
 char *oslToCCode(osl_scop_p scop);
+/// Generate code and record the character ranges occupied by the statement with each beta-vector.
+char *oslToCCode(osl_scop_p scop, std::multimap<std::vector<int>, std::pair<int, int>> &positions);
 char *fileContents(FILE *file);
 
 char *escapeHtml(char *);
-std::multimap<std::vector<int>, std::pair<int, int>> stmtPositionsInCode(osl_scop_p scop);
-std::multimap<std::vector<int>, std::pair<int, int>> stmtPositionsInHtml(osl_scop_p scop);
 
 osl_scop_p parseCode(char *code);
 int parseClay(osl_scop_p scop, char *script);
@@ -0,0 +1,200 @@
+#ifndef POINTBUFFER_H
+#define POINTBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "macros.h"
+
+/**
+ * @brief A contiguous, row-major buffer of integer points with fixed stride.
+ *
+ * Every point occupies exactly stride() consecutive coordinates, so a set of
+ * points is stored in a single allocation and can be traversed linearly.
+ * Individual points are accessed through lightweight non-owning Row views.
+ */
+class PointBuffer {
+public:
+  typedef int32_t value_type;
+
+  /**
+   * @brief Non-owning view of a single point inside a PointBuffer.
+   * The view is invalidated by any operation that reallocates the buffer.
+   */
+  class Row {
+  public:
+    Row(const value_type *data, size_t size) :
+      m_data(data), m_size(size) {
+    }
+
+    value_type operator [](size_t idx) const {
+      return m_data[idx];
+    }
+
+    size_t size() const {
+      return m_size;
+    }
+
+    bool empty() const {
+      return m_size == 0;
+    }
+
+    const value_type *data() const {
+      return m_data;
+    }
+
+    const value_type *begin() const {
+      return m_data;
+    }
+
+    const value_type *end() const {
+      return m_data + m_size;
+    }
+
+    std::vector<int> toVector() const {
+      return std::vector<int>(begin(), end());
+    }
+
+  private:
+    const value_type *m_data;
+    size_t m_size;
+  };
+
+  class const_iterator {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Row value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef void pointer;
+    typedef Row reference;
+
+    const_iterator(const PointBuffer::value_type *data, size_t stride, size_t index) :
+      m_data(data), m_stride(stride), m_index(index) {
+    }
+
+    Row operator *() const {
+      return Row(m_data + m_index * m_stride, m_stride);
+    }
+
+    const_iterator &operator ++() {
+      ++m_index;
+      return *this;
+    }
+
+    const_iterator operator ++(int) {
+      const_iterator copy(*this);
+      ++m_index;
+      return copy;
+    }
+
+    // Compare indices rather than pointers, zero-stride buffers still hold points.
+    bool operator ==(const const_iterator &other) const {
+      return m_index == other.m_index;
+    }
+
+    bool operator !=(const const_iterator &other) const {
+      return m_index != other.m_index;
+    }
+
+  private:
+    const PointBuffer::value_type *m_data;
+    size_t m_stride;
+    size_t m_index;
+  };
+
+  explicit PointBuffer(size_t stride = 0) :
+    m_stride(stride), m_size(0) {
+  }
+
+  size_t stride() const {
+    return m_stride;
+  }
+
+  /// Number of points in the buffer.
+  size_t size() const {
+    return m_size;
+  }
+
+  bool empty() const {
+    return m_size == 0;
+  }
+
+  Row operator [](size_t idx) const {
+    CLINT_ASSERT(idx < m_size, "Point index out of bounds");
+    return Row(m_data.data() + idx * m_stride, m_stride);
+  }
+
+  Row front() const {
+    return (*this)[0];
+  }
+
+  const_iterator begin() const {
+    return const_iterator(m_data.data(), m_stride, 0);
+  }
+
+  const_iterator end() const {
+    return const_iterator(m_data.data(), m_stride, m_size);
+  }
+
+  /// Raw row-major storage, size() * stride() elements.
+  const value_type *data() const {
+    return m_data.data();
+  }
+
+  value_type *data() {
+    return m_data.data();
+  }
+
+  void reserve(size_t points) {
+    m_data.reserve(points * m_stride);
+  }
+
+  /// Resize to the given number of points, new coordinates are zero-initialized.
+  void resize(size_t points) {
+    m_data.resize(points * m_stride);
+    m_size = points;
+  }
+
+  void clear() {
+    m_data.clear();
+    m_size = 0;
+  }
+
+  /**
+   * @brief Append a new point and return the pointer to its stride() coordinates.
+   * The coordinates are zero-initialized; the pointer is invalidated by the next append.
+   */
+  value_type *appendRow() {
+    m_data.resize(m_data.size() + m_stride);
+    ++m_size;
+    return m_data.data() + (m_size - 1) * m_stride;
+  }
+
+  /// Remove the last point, e.g. after it was written by appendRow and turned out to be unnecessary.
+  void removeLast() {
+    CLINT_ASSERT(m_size != 0, "Removing from an empty buffer");
+    m_data.resize(m_data.size() - m_stride);
+    --m_size;
+  }
+
+  template <typename Iterator>
+  void append(Iterator first, Iterator last) {
+    CLINT_ASSERT(static_cast<std::size_t>(std::distance(first, last)) == m_stride,
+                 "Point size does not match the buffer stride");
+    m_data.insert(m_data.end(), first, last);
+    ++m_size;
+  }
+
+  void append(Row row) {
+    append(row.begin(), row.end());
+  }
+
+private:
+  std::vector<value_type> m_data;
+  size_t m_stride;
+  size_t m_size;
+};
+
+#endif // POINTBUFFER_H
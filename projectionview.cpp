@@ -3,6 +3,8 @@
 
 #include "projectionview.h"
 
+#include <cmath>
+
 ProjectionView::ProjectionView(QWidget *parent) :
   QGraphicsView(parent) {
 }
@@ -31,3 +33,33 @@ void ProjectionView::mouseDoubleClickEvent(QMouseEvent *event) {
     QGraphicsView::mouseDoubleClickEvent(event);
   emit doubleclicked();
 }
+
+QRectF ProjectionView::visibleSceneRect() const {
+  return mapToScene(viewport()->rect()).boundingRect();
+}
+
+void ProjectionView::wheelEvent(QWheelEvent *event) {
+  if (!(event->modifiers() & Qt::ControlModifier)) {
+    QGraphicsView::wheelEvent(event);
+    return;
+  }
+
+  // Zoom around the mouse cursor, one wheel step scales by 15%.
+  const double factor = std::pow(1.15, event->angleDelta().y() / 120.0);
+  ViewportAnchor anchor = transformationAnchor();
+  setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+  scale(factor, factor);
+  setTransformationAnchor(anchor);
+  event->accept();
+  emit viewportChanged(visibleSceneRect());
+}
+
+void ProjectionView::resizeEvent(QResizeEvent *event) {
+  QGraphicsView::resizeEvent(event);
+  emit viewportChanged(visibleSceneRect());
+}
+
+void ProjectionView::scrollContentsBy(int dx, int dy) {
+  QGraphicsView::scrollContentsBy(dx, dy);
+  emit viewportChanged(visibleSceneRect());
+}
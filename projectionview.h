@@ -17,14 +17,21 @@ public:
     return m_active;
   }
 
+  /// Part of the scene currently visible in the viewport.
+  QRectF visibleSceneRect() const;
+
 protected:
   void mousePressEvent(QMouseEvent *event);
   void mouseReleaseEvent(QMouseEvent *event);
   void mouseMoveEvent(QMouseEvent *event);
   void mouseDoubleClickEvent(QMouseEvent *event);
+  void wheelEvent(QWheelEvent *event);
+  void resizeEvent(QResizeEvent *event);
+  void scrollContentsBy(int dx, int dy);
 
 signals:
   void doubleclicked();
+  void viewportChanged(const QRectF &visibleSceneRect);
 
 private:
   bool m_active = true;
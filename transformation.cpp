@@ -1 +1,153 @@
 #include "transformation.h"
+
+#include <utility>
+
+namespace {
+
+struct CanonicalEntry {
+  size_t group;
+  Transformation transformation;
+};
+
+bool isIdentity(const Transformation &transformation) {
+  switch (transformation.kind()) {
+  case Transformation::Kind::Shift:
+    return transformation.iterators().empty() &&
+        transformation.constantAmount() == 0 &&
+        std::all_of(std::begin(transformation.parameters()), std::end(transformation.parameters()),
+                    [](int p) { return p == 0; });
+  case Transformation::Kind::Skew:
+    return transformation.constantAmount() == 0;
+  case Transformation::Kind::Reorder:
+    for (size_t i = 0; i < transformation.order().size(); i++) {
+      if (transformation.order()[i] != static_cast<int>(i))
+        return false;
+    }
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool sameLoop(const Transformation &first, const Transformation &second) {
+  return first.target() == second.target() && first.depth() == second.depth();
+}
+
+// Replace the transformation @p first directly followed by @p second with zero or one transformations
+// put into @p combined.  Returns false if they cannot be combined.
+bool combine(const Transformation &first, const Transformation &second, std::vector<Transformation> &combined) {
+  typedef Transformation::Kind Kind;
+  if (first.kind() == Kind::Tile && second.kind() == Kind::Linearize) {
+    // Linearizing the point loop of a tile restores the original loop.
+    std::vector<int> pointLoop = first.target();
+    pointLoop.push_back(0);
+    return static_cast<int>(first.target().size()) == first.depth() &&
+        second.depth() == first.depth() &&
+        second.target() == pointLoop;
+  }
+  if (first.kind() == Kind::Densify && second.kind() == Kind::Densify && sameLoop(first, second)) {
+    // The loop is already dense.
+    combined.push_back(first);
+    return true;
+  }
+
+  if (first.kind() != second.kind() || first.target() != second.target())
+    return false;
+
+  switch (first.kind()) {
+  case Kind::Shift:
+  {
+    // Variable shifts are written as skews, keep them.
+    if (first.depth() != second.depth() || !first.iterators().empty() || !second.iterators().empty())
+      return false;
+    std::vector<int> parameters = first.parameters();
+    parameters.resize(std::max(parameters.size(), second.parameters().size()), 0);
+    for (size_t i = 0; i < second.parameters().size(); i++) {
+      parameters[i] += second.parameters()[i];
+    }
+    combined.push_back(Transformation::rawShift(first.target(), first.depth(), parameters,
+                                                first.constantAmount() + second.constantAmount()));
+    return true;
+  }
+  case Kind::Skew:
+    if (first.depth() != second.depth() || first.secondDepth() != second.secondDepth())
+      return false;
+    combined.push_back(Transformation::skew(first.target(), first.depth(), first.secondDepth(),
+                                            first.constantAmount() + second.constantAmount()));
+    return true;
+  case Kind::Reorder:
+  {
+    if (first.order().size() != second.order().size())
+      return false;
+    // Child i is moved to first.order()[i], and from there to second.order()[first.order()[i]].
+    std::vector<int> order(first.order().size());
+    for (size_t i = 0; i < order.size(); i++) {
+      int position = first.order()[i];
+      if (position < 0 || position >= static_cast<int>(order.size()))
+        return false;
+      order[i] = second.order()[position];
+    }
+    combined.push_back(Transformation::rawReorder(first.target(), order));
+    return true;
+  }
+  case Kind::Reverse:
+    return first.depth() == second.depth();
+  case Kind::Interchange:
+    return (first.depth() == second.depth() && first.secondDepth() == second.secondDepth()) ||
+        (first.depth() == second.secondDepth() && first.secondDepth() == second.depth());
+  default:
+    return false;
+  }
+}
+
+void push(std::vector<CanonicalEntry> &stack, CanonicalEntry entry) {
+  if (isIdentity(entry.transformation))
+    return;
+  // Densifying a grained loop restores it only if it was dense before the grain, which is
+  // known when the grain directly follows a densify of the same loop.
+  if (entry.transformation.kind() == Transformation::Kind::Densify && stack.size() >= 2) {
+    const Transformation &grain = stack[stack.size() - 1].transformation;
+    const Transformation &densify = stack[stack.size() - 2].transformation;
+    if (grain.kind() == Transformation::Kind::Grain && sameLoop(grain, entry.transformation) &&
+        densify.kind() == Transformation::Kind::Densify && sameLoop(densify, entry.transformation)) {
+      stack.pop_back();
+      return;
+    }
+  }
+  std::vector<Transformation> combined;
+  if (!stack.empty() && combine(stack.back().transformation, entry.transformation, combined)) {
+    stack.pop_back();
+    // The result may in turn combine with the preceding transformation.
+    for (const Transformation &transformation : combined) {
+      push(stack, CanonicalEntry {entry.group, transformation});
+    }
+  } else {
+    stack.push_back(std::move(entry));
+  }
+}
+
+std::vector<CanonicalEntry> canonicalEntries(const std::vector<TransformationGroup> &groups, size_t firstGroup) {
+  std::vector<CanonicalEntry> stack;
+  for (size_t groupIdx = firstGroup; groupIdx < groups.size(); ++groupIdx) {
+    for (const Transformation &transformation : groups[groupIdx].transformations) {
+      push(stack, CanonicalEntry {groupIdx, transformation});
+    }
+  }
+  return std::move(stack);
+}
+
+} // end anonymous namespace
+
+std::vector<TransformationGroup> canonicalGroups(const std::vector<TransformationGroup> &groups,
+                                                 size_t firstGroup) {
+  std::vector<TransformationGroup> canonical;
+  size_t lastGroup = groups.size();
+  for (CanonicalEntry &entry : canonicalEntries(groups, firstGroup)) {
+    if (entry.group != lastGroup) {
+      canonical.emplace_back();
+      lastGroup = entry.group;
+    }
+    canonical.back().transformations.push_back(std::move(entry.transformation));
+  }
+  return std::move(canonical);
+}
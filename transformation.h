@@ -4,6 +4,8 @@
 #include <vector>
 #include <algorithm>
 
+#include <boost/functional/hash.hpp>
+
 #include "macros.h"
 
 class Transformation {
@@ -59,6 +61,34 @@ public:
     return m_iterators;
   }
 
+  bool operator ==(const Transformation &other) const {
+    return m_kind == other.m_kind &&
+        m_targetBeta == other.m_targetBeta &&
+        m_depthInner == other.m_depthInner &&
+        m_depthOuter == other.m_depthOuter &&
+        m_constantAmount == other.m_constantAmount &&
+        m_order == other.m_order &&
+        m_parameters == other.m_parameters &&
+        m_iterators == other.m_iterators;
+  }
+
+  bool operator !=(const Transformation &other) const {
+    return !(*this == other);
+  }
+
+  friend std::size_t hash_value(const Transformation &t) {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, static_cast<int>(t.m_kind));
+    boost::hash_combine(seed, t.m_targetBeta);
+    boost::hash_combine(seed, t.m_depthInner);
+    boost::hash_combine(seed, t.m_depthOuter);
+    boost::hash_combine(seed, t.m_constantAmount);
+    boost::hash_combine(seed, t.m_order);
+    boost::hash_combine(seed, t.m_parameters);
+    boost::hash_combine(seed, t.m_iterators);
+    return seed;
+  }
+
   static Transformation constantShift(const std::vector<int> &beta, int dimension, int amount) {
     CLINT_ASSERT(dimension <= beta.size(), "Dimension overflow");
     Transformation t;
@@ -333,14 +363,15 @@ public:
 
 private:
   std::vector<int> m_targetBeta;
-  int m_depthInner, m_depthOuter;
-  int m_constantAmount;
+  // Fields unused by a kind stay zero so that equal transformations compare and hash equal.
+  int m_depthInner = 0, m_depthOuter = 0;
+  int m_constantAmount = 0;
   std::vector<int> m_order;
 
   std::vector<int> m_parameters;
   std::vector<int> m_iterators;
 
-  Kind m_kind;
+  Kind m_kind = Kind::Shift;
 
   static void unwrapClayList(const std::vector<std::vector<int>> &list, Transformation &t) {
     CLINT_ASSERT(list.size() == 4, "List malformed");
@@ -355,10 +386,36 @@ private:
 
 struct TransformationGroup {
   std::vector<Transformation> transformations;
+
+  bool operator ==(const TransformationGroup &other) const {
+    return transformations == other.transformations;
+  }
+
+  bool operator !=(const TransformationGroup &other) const {
+    return !(*this == other);
+  }
+
+  friend std::size_t hash_value(const TransformationGroup &group) {
+    return boost::hash_range(std::begin(group.transformations), std::end(group.transformations));
+  }
 };
 
 struct TransformationSequence {
   std::vector<TransformationGroup> groups;
 };
 
+/// Groups of @p groups starting from @p firstGroup after peephole minimization: adjacent shifts, skews
+/// and reorders of the same target are merged, inverse pairs and identities are removed.  A grain is
+/// only cancelled by a following densify when a densify of the same loop directly precedes it.  A merged
+/// transformation belongs to the group of its last part, emptied groups are removed.  Applying the
+/// result has the same effect on the scop as applying the groups.
+std::vector<TransformationGroup> canonicalGroups(const std::vector<TransformationGroup> &groups,
+                                                 size_t firstGroup = 0);
+
+inline TransformationSequence canonicalSequence(const TransformationSequence &sequence) {
+  TransformationSequence canonical;
+  canonical.groups = canonicalGroups(sequence.groups);
+  return canonical;
+}
+
 #endif // TRANSFORMATION_H
@@ -0,0 +1,180 @@
+#include "transformationworker.h"
+#include "macros.h"
+#include "oslutils.h"
+#include "transformer.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+TransformationWorker::TransformationWorker(QObject *parent) :
+  QObject(parent), m_cancelled(false) {
+  m_thread = std::thread(&TransformationWorker::run, this);
+}
+
+TransformationWorker::~TransformationWorker() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopped = true;
+    m_cancelled = true;
+  }
+  m_condition.notify_one();
+  m_thread.join();
+
+  for (auto &element : m_pending)
+    freeJob(*element.second);
+  for (auto &element : m_results)
+    freeResult(*element.second);
+}
+
+void TransformationWorker::freeJob(Job &job) {
+  if (job.original != nullptr)
+    osl_scop_free(job.original);
+  if (job.base != nullptr)
+    osl_scop_free(job.base);
+  if (job.analyzed != nullptr)
+    osl_scop_free(job.analyzed);
+  job.original = nullptr;
+  job.base = nullptr;
+  job.analyzed = nullptr;
+}
+
+void TransformationWorker::freeResult(Result &result) {
+  if (result.transformed != nullptr)
+    osl_scop_free(result.transformed);
+  free(result.generatedCode);
+  result.transformed = nullptr;
+  result.generatedCode = nullptr;
+}
+
+unsigned TransformationWorker::submit(Job &&job) {
+  unsigned generation;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_ptr<Job> &pending = m_pending[job.owner];
+    if (pending)
+      freeJob(*pending);
+    generation = ++m_generation;
+    job.generation = generation;
+    if (m_runningOwner == job.owner)
+      m_cancelled = true;
+    pending.reset(new Job(std::move(job)));
+  }
+  m_condition.notify_one();
+  return generation;
+}
+
+void TransformationWorker::cancel(const void *owner) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto pending = m_pending.find(owner);
+  if (pending != std::end(m_pending)) {
+    freeJob(*pending->second);
+    m_pending.erase(pending);
+  }
+  if (m_runningOwner == owner)
+    m_cancelled = true;
+  auto result = m_results.find(owner);
+  if (result != std::end(m_results)) {
+    freeResult(*result->second);
+    m_results.erase(result);
+  }
+}
+
+bool TransformationWorker::takeResult(const void *owner, unsigned generation, Result &result) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto found = m_results.find(owner);
+  if (found == std::end(m_results))
+    return false;
+  bool matches = found->second->generation == generation;
+  if (matches)
+    result = std::move(*found->second);
+  else
+    freeResult(*found->second);
+  m_results.erase(found);
+  return matches;
+}
+
+void TransformationWorker::run() {
+  while (true) {
+    std::unique_ptr<Job> job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_condition.wait(lock, [this] { return m_stopped || !m_pending.empty(); });
+      if (m_stopped)
+        return;
+      // Generations increase with submission, run the oldest pending job first.
+      auto oldest = std::min_element(std::begin(m_pending), std::end(m_pending),
+                                     [](const std::pair<const void *const, std::unique_ptr<Job>> &a,
+                                        const std::pair<const void *const, std::unique_ptr<Job>> &b) {
+        return a.second->generation < b.second->generation;
+      });
+      job = std::move(oldest->second);
+      m_pending.erase(oldest);
+      m_runningOwner = job->owner;
+      m_cancelled = false;
+    }
+
+    Result result;
+    result.owner = job->owner;
+    result.generation = job->generation;
+    bool completed = execute(*job, result);
+    freeJob(*job);
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_runningOwner = nullptr;
+      if (!completed || isCancelled()) {
+        freeResult(result);
+        continue;
+      }
+      std::unique_ptr<Result> &stored = m_results[result.owner];
+      if (stored)
+        freeResult(*stored);
+      stored.reset(new Result(std::move(result)));
+    }
+    // The receivers live in the GUI thread, so the connection is queued.
+    emit executed();
+  }
+}
+
+bool TransformationWorker::execute(Job &job, Result &result) {
+  ClayTransformer transformer;
+  // Candl calls of all workers, including legality previews, are serialized by CandlAnalyzer.
+  std::unique_ptr<DependenceAnalyzer> analyzer(DependenceAnalyzer::create(DependenceAnalyzer::backend()));
+
+  // The job owns the base scop, transform it in place.
+  result.transformed = job.base;
+  job.base = nullptr;
+  result.nbGroups = job.groups.size();
+  try {
+    for (const TransformationGroup &group : canonicalGroups(job.groups, job.firstGroup)) {
+      if (isCancelled())
+        return false;
+      transformer.apply(result.transformed, group);
+    }
+  } catch (std::exception &) {
+    // Leave the scop without the result, the owner executes synchronously and reports the error.
+    osl_scop_free(result.transformed);
+    result.transformed = nullptr;
+    return true;
+  }
+
+  if (job.analyzeDependences) {
+    if (isCancelled())
+      return false;
+    if (job.legality == nullptr || !job.legality->find(job.scopPart, result.transformed, result.dependences)) {
+      result.dependences = job.analyzed != nullptr ?
+            analyzer->reanalyze(job.original, result.transformed, job.analyzed, job.analyzedDependences) :
+            analyzer->analyze(job.original, result.transformed);
+      if (job.legality != nullptr)
+        job.legality->store(job.scopPart, result.transformed, result.dependences);
+    }
+  }
+
+  if (job.generateCode) {
+    if (isCancelled())
+      return false;
+    result.generatedCode = oslToCCode(result.transformed, result.positions);
+  }
+  return true;
+}
@@ -0,0 +1,99 @@
+#ifndef TRANSFORMATIONWORKER_H
+#define TRANSFORMATIONWORKER_H
+
+#include <QObject>
+
+#include <osl/osl.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dependenceanalyzer.h"
+#include "legalitycache.h"
+#include "transformation.h"
+
+/**
+ * @brief Executes transformation sequences on a background thread.
+ *
+ * The worker applies the transformations with Clay, analyzes dependences with Candl and/or
+ * generates code with CLooG, none of which touches the objects of the GUI thread.  Dependences
+ * are only analyzed through DependenceAnalyzer::create(), whose Candl backend serializes Candl
+ * calls between all workers and the GUI thread.  Each owner
+ * has at most one pending job and one result: submitting a new job supersedes the pending job
+ * of the same owner and cancels its running one at the next checkpoint, i.e. between
+ * transformation groups or stages.  Jobs of different owners never supersede each other and
+ * run in submission order.  Only the minimized remainder of the sequence is applied, see
+ * canonicalGroups().
+ * Completion is signaled by executed(), which is delivered to the receivers in the GUI thread
+ * through a queued connection; they collect the result with takeResult().
+ */
+class TransformationWorker : public QObject {
+  Q_OBJECT
+public:
+  struct Job {
+    const void *owner;
+    unsigned generation;                      ///< Assigned by submit().
+    osl_scop_p original;                      ///< Copy of the original scop, owned by the job; only needed for the analysis.
+    osl_scop_p scopPart = nullptr;            ///< Original scop of the owner, only a key of the legality cache.
+    LegalityCache *legality = nullptr;        ///< Cache of analysis results, may be null.
+    osl_scop_p analyzed = nullptr;            ///< Copy of the scop the owner's dependences were last analyzed for, owned by the job.
+    DependenceAnalyzer::DependenceMap analyzedDependences;  ///< Result of that analysis, rechecked incrementally.
+    osl_scop_p base;                          ///< Copy of the scop with the first firstGroup groups applied, owned by the job.
+    size_t firstGroup;
+    std::vector<TransformationGroup> groups;  ///< Complete sequence, groups before firstGroup are not applied.
+    bool analyzeDependences = true;
+    bool generateCode = true;
+  };
+
+  struct Result {
+    const void *owner = nullptr;
+    unsigned generation = 0;
+    size_t nbGroups = 0;
+    osl_scop_p transformed = nullptr;
+    DependenceAnalyzer::DependenceMap dependences;
+    char *generatedCode = nullptr;
+    std::multimap<std::vector<int>, std::pair<int, int>> positions;
+  };
+
+  explicit TransformationWorker(QObject *parent = nullptr);
+  ~TransformationWorker();
+
+  /// Queue @p job in place of the pending one of its owner and return its generation, unique among all submitted jobs.
+  unsigned submit(Job &&job);
+
+  /// Move the result of the job (@p owner, @p generation) into @p result, older results of @p owner are discarded.
+  bool takeResult(const void *owner, unsigned generation, Result &result);
+
+  /// Discard the pending job and the result of @p owner and cancel its running job.
+  void cancel(const void *owner);
+
+signals:
+  void executed();
+
+private:
+  void run();
+  bool execute(Job &job, Result &result);
+  bool isCancelled() const {
+    return m_cancelled.load(std::memory_order_relaxed);
+  }
+
+  static void freeJob(Job &job);
+  static void freeResult(Result &result);
+
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::map<const void *, std::unique_ptr<Job>> m_pending;
+  std::map<const void *, std::unique_ptr<Result>> m_results;
+  const void *m_runningOwner = nullptr;
+  unsigned m_generation = 0;
+  std::atomic<bool> m_cancelled;
+  bool m_stopped = false;
+};
+
+#endif // TRANSFORMATIONWORKER_H
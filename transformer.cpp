@@ -12,8 +12,58 @@
 #include <chlore/chlore.h>
 
 void ClayTransformer::apply(osl_scop_p scop, const Transformation &transformation) {
-  int err = 0;
   clay_beta_normalize(scop);
+  applyUnnormalized(scop, transformation);
+  clay_beta_normalize(scop);
+}
+
+// Transformations that only change the scattering of the statements but not their betas.  Applied
+// to a scop with normalized betas, they leave them normalized.
+bool ClayTransformer::preservesBetas(Transformation::Kind kind) {
+  switch (kind) {
+  case Transformation::Kind::Shift:
+  case Transformation::Kind::Skew:
+  case Transformation::Kind::Reshape:
+  case Transformation::Kind::Grain:
+  case Transformation::Kind::Densify:
+  case Transformation::Kind::Reverse:
+  case Transformation::Kind::Interchange:
+  case Transformation::Kind::Tile:
+  case Transformation::Kind::Linearize:
+    return true;
+  default:
+    return false;
+  }
+}
+
+void ClayTransformer::apply(osl_scop_p scop, const TransformationGroup &group) {
+  if (!m_deferredNormalization) {
+    Transformer::apply(scop, group);
+    return;
+  }
+
+  bool normalized = false;
+  m_options->normalize = 0;
+  try {
+    for (const Transformation &transformation : group.transformations) {
+      if (!normalized) {
+        clay_beta_normalize(scop);
+        normalized = true;
+      }
+      applyUnnormalized(scop, transformation);
+      normalized = preservesBetas(transformation.kind());
+    }
+  } catch (...) {
+    m_options->normalize = 1;
+    throw;
+  }
+  m_options->normalize = 1;
+  if (!normalized)
+    clay_beta_normalize(scop);
+}
+
+void ClayTransformer::applyUnnormalized(osl_scop_p scop, const Transformation &transformation) {
+  int err = 0;
   switch (transformation.kind()) {
   case Transformation::Kind::Fuse:
     err = clay_fuse(scop, ClayBeta(transformation.target()), m_options);
@@ -110,7 +160,6 @@ void ClayTransformer::apply(osl_scop_p scop, const Transformation &transformatio
   if (err != CLAY_SUCCESS) {
     throw std::logic_error(std::string(clay_error_message_text(err)));
   }
-  clay_beta_normalize(scop);
 }
 
 boost::optional<Transformation> ClayTransformer::guessInverseTransformation(osl_scop_p scop, const Transformation &transformation) {
@@ -73,13 +73,30 @@ public:
 
   boost::optional<Transformation> guessInverseTransformation(osl_scop_p scop, const Transformation &transformation) override;
   void apply(osl_scop_p scop, const Transformation &transformation) override;
+  void apply(osl_scop_p scop, const TransformationGroup &group) override;
+  using Transformer::apply;
+
+  /// Whether groups are applied with a single beta normalization at their end instead of one per transformation.
+  /// Betas are still normalized before any transformation that follows one that may change them, so the targets
+  /// of all transformations, and ClayBetaMapper that computes them, see normalized betas in both modes.
+  bool deferredNormalization() const {
+    return m_deferredNormalization;
+  }
+
+  void setDeferredNormalization(bool deferred) {
+    m_deferredNormalization = deferred;
+  }
 
   ~ClayTransformer() {
     clay_options_free(m_options);
   }
 
 private:
+  void applyUnnormalized(osl_scop_p scop, const Transformation &transformation);
+  static bool preservesBetas(Transformation::Kind kind);
+
   clay_options_p m_options;
+  bool m_deferredNormalization = true;
 };
 
 class StmtLoopPosition {
@@ -93,14 +93,13 @@ bool VizCoordinateSystem::projectStatementOccurrence(ClintStmtOccurrence *occurr
   m_polyhedra.push_back(vp);
   polyhedronUpdated(vp);
 
-  int occurrenceHorizontalMin = occurrence->minimumValue(m_horizontalDimensionIdx);
-  int occurrenceHorizontalMax = occurrence->maximumValue(m_horizontalDimensionIdx);
-  int occurrenceVerticalMin   = occurrence->minimumValue(m_verticalDimensionIdx);
-  int occurrenceVerticalMax   = occurrence->maximumValue(m_verticalDimensionIdx);
-  setMinMax(std::min(occurrenceHorizontalMin, m_horizontalMin),
-            std::max(occurrenceHorizontalMax, m_horizontalMax),
-            std::min(occurrenceVerticalMin, m_verticalMin),
-            std::max(occurrenceVerticalMax, m_verticalMax));
+  std::pair<int, int> occurrenceHorizontal, occurrenceVertical;
+  std::tie(occurrenceHorizontal, occurrenceVertical) =
+      occurrence->boundingBox(m_horizontalDimensionIdx, m_verticalDimensionIdx);
+  setMinMax(std::min(occurrenceHorizontal.first, m_horizontalMin),
+            std::max(occurrenceHorizontal.second, m_horizontalMax),
+            std::min(occurrenceVertical.first, m_verticalMin),
+            std::max(occurrenceVertical.second, m_verticalMax));
 
   const VizProperties *props = projection()->vizProperties();
   if (props->filledPolygons())
@@ -137,9 +136,7 @@ void VizCoordinateSystem::updateInnerDependences() {
         continue;
 
       for (ClintDependence *dep : dependences) {
-        std::vector<std::vector<int>> lines =
-            dep->projectOn(m_horizontalDimensionIdx, m_verticalDimensionIdx);
-        setInnerDependencesBetween(vp1, vp2, std::move(lines), dep->isViolated());
+        setInnerDependencesBetween(vp1, vp2, dep);
       }
     }
   }
@@ -148,8 +145,8 @@ void VizCoordinateSystem::updateInnerDependences() {
 }
 
 void VizCoordinateSystem::setInnerDependencesBetween(VizPolyhedron *vp1, VizPolyhedron *vp2,
-                                                     std::vector<std::vector<int>> &&lines, bool violated) {
-  vizDependenceArrowsCreate(vp1, vp2, std::forward<std::vector<std::vector<int>>>(lines), violated, this, m_depArrows);
+                                                     ClintDependence *dependence) {
+  vizDependenceArrowsCreate(vp1, vp2, dependence, dependence->isViolated(), this, m_depArrows);
 }
 
 void VizCoordinateSystem::updateInternalDependences() {
@@ -158,6 +155,18 @@ void VizCoordinateSystem::updateInternalDependences() {
   }
 }
 
+void VizCoordinateSystem::updateViewport(const QRectF &visibleSceneRect) {
+  bool changed = false;
+  for (VizPolyhedron *vp : m_polyhedra) {
+    changed = vp->updateClipping(visibleSceneRect) || changed;
+    changed = vp->updateLevelOfDetail() || changed;
+  }
+  // Arrows between polyhedra refer to points that may have been replaced.
+  if (changed) {
+    updateInnerDependences();
+  }
+}
+
 
 std::vector<int> VizCoordinateSystem::betaPrefix() const {
 //  // FIXME: this works only for the first two dimensions, betas should be set up in construction
@@ -11,6 +11,7 @@
 #include "clintstmt.h"
 #include "vizproperties.h"
 
+class ClintDependence;
 class VizPolyhedron;
 class VizProjection;
 class VizDepArrow;
@@ -90,7 +91,8 @@ public:
   bool projectStatementOccurrence(ClintStmtOccurrence *occurrence);
   void updateInnerDependences();
   void updateInternalDependences();
-  void setInnerDependencesBetween(VizPolyhedron *vp1, VizPolyhedron *vp2, std::vector<std::vector<int>> &&lines, bool violated);
+  void updateViewport(const QRectF &visibleSceneRect);
+  void setInnerDependencesBetween(VizPolyhedron *vp1, VizPolyhedron *vp2, ClintDependence *dependence);
 
   void extendHorizontally(int minimum, int maximum) {
     m_horizontalMin = std::min(m_horizontalMin, minimum);
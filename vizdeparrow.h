@@ -8,7 +8,11 @@
 #include "vizproperties.h"
 #include "vizpoint.h"
 #include "vizpolyhedron.h"
+#include "clintdependence.h"
+#include "pointbuffer.h"
 
+#include <algorithm>
+#include <functional>
 #include <unordered_set>
 
 class VizDepArrow : public QGraphicsObject {
@@ -42,7 +46,7 @@ private:
 template <typename ParentType>
 void vizDependenceArrowsCreate(VizPolyhedron *sourcePolyhedron,
                                VizPolyhedron *targetPolyhedron,
-                               std::vector<std::vector<int> > &&dependences,
+                               ClintDependence *dependence,
                                bool violated,
                                ParentType *parentObject,
                                std::unordered_set<VizDepArrow *> &set) {
@@ -51,27 +55,16 @@ void vizDependenceArrowsCreate(VizPolyhedron *sourcePolyhedron,
 
   typedef std::pair<std::pair<int, int>, std::pair<int, int>> DepCoordinates;
   std::unordered_set<DepCoordinates, boost::hash<DepCoordinates>> existingDependences;
+  std::vector<int> sourceCoordinates(sourceInputDimensionality);
+  std::vector<int> targetCoordinates(targetInputDimensionality);
 
-  for (const std::vector<int> &dep : dependences) {
-    CLINT_ASSERT(sourceInputDimensionality + targetInputDimensionality <= dep.size(),
-                 "Not enough dimensions in a dependence projection");
-    std::vector<int> sourceCoordinates(std::begin(dep),
-                                       std::begin(dep) + sourceInputDimensionality);
-    std::vector<int> targetCoordinates(std::begin(dep) + sourceInputDimensionality,
-                                       std::begin(dep) + sourceInputDimensionality + targetInputDimensionality);
-
-    VizPoint *sourcePoint = sourcePolyhedron->point(sourceCoordinates),
-             *targetPoint = targetPolyhedron->point(targetCoordinates);
-
-    if (!sourcePoint || !targetPoint)
-      continue;
-
+  auto addArrow = [&](VizPoint *sourcePoint, VizPoint *targetPoint) {
     DepCoordinates depCoordinates = std::make_pair(sourcePoint->scatteredCoordinates(),
                                                    targetPoint->scatteredCoordinates());
 
     // Omit self-dependences.
     if (depCoordinates.first == depCoordinates.second)
-      continue;
+      return;
 
     if (existingDependences.count(depCoordinates) == 0) {
       VizDepArrow *depArrow = new VizDepArrow(sourcePoint, targetPoint,
@@ -84,6 +77,42 @@ void vizDependenceArrowsCreate(VizPolyhedron *sourcePolyhedron,
       set.insert(depArrow);
       existingDependences.emplace(depCoordinates);
     }
+  };
+
+  // Uniform dependences are drawn by translating the points of the source polyhedron, the
+  // dependence relation is not enumerated.
+  if (dependence->isUniform() &&
+      dependence->sourceDimensionality() == sourceInputDimensionality &&
+      dependence->targetDimensionality() == targetInputDimensionality) {
+    const std::vector<int> &distance = dependence->distance();
+    sourcePolyhedron->forEachPoint([&](VizPoint *sourcePoint) {
+      const std::vector<int> &sourceCoordinates = sourcePoint->originalCoordinates();
+      if (!dependence->hasSourceInstance(sourceCoordinates))
+        return;
+      std::transform(std::begin(sourceCoordinates), std::end(sourceCoordinates),
+                     std::begin(distance), std::begin(targetCoordinates), std::plus<int>());
+      if (VizPoint *targetPoint = targetPolyhedron->point(targetCoordinates))
+        addArrow(sourcePoint, targetPoint);
+    });
+    return;
+  }
+
+  // Dependence instances are cached by the program enumerator, only the arrows are stored here.
+  for (PointBuffer::Row dep : dependence->projectedPoints()) {
+    CLINT_ASSERT(sourceInputDimensionality + targetInputDimensionality <= dep.size(),
+                 "Not enough dimensions in a dependence projection");
+    std::copy(std::begin(dep),
+              std::begin(dep) + sourceInputDimensionality,
+              std::begin(sourceCoordinates));
+    std::copy(std::begin(dep) + sourceInputDimensionality,
+              std::begin(dep) + sourceInputDimensionality + targetInputDimensionality,
+              std::begin(targetCoordinates));
+
+    VizPoint *sourcePoint = sourcePolyhedron->point(sourceCoordinates),
+             *targetPoint = targetPolyhedron->point(targetCoordinates);
+
+    if (sourcePoint && targetPoint)
+      addArrow(sourcePoint, targetPoint);
   }
 }
 #endif // VIZDEPARROW_H
@@ -29,6 +29,7 @@ void VizManipulationManager::polyhedronAboutToMove(VizPolyhedron *polyhedron) {
   CLINT_ASSERT(m_polyhedron == nullptr, "Active polyhedron is already being manipulated");
   m_polyhedron = polyhedron;
   ensureTargetConsistency();
+  endLegalityPreview();
 
   m_horzOffset = 0;
   m_vertOffset = 0;
@@ -85,13 +86,90 @@ void VizManipulationManager::polyhedronMoving(VizPolyhedron *polyhedron, QPointF
       emit intentionMoveVertically(vertOffset - m_vertOffset);
       m_vertOffset = vertOffset;
     }
+
+    previewLegality(std::vector<VizPolyhedron *>(std::begin(selectedPolyhedra), std::end(selectedPolyhedra)),
+                    movementGroup(selectedPolyhedra, m_horzOffset, m_vertOffset));
+  }
+}
+
+TransformationGroup VizManipulationManager::movementGroup(const std::unordered_set<VizPolyhedron *> &polyhedra,
+                                                          int horzOffset, int vertOffset) {
+  TransformationGroup group;
+  for (VizPolyhedron *vp : polyhedra) {
+    const std::vector<int> beta = vp->occurrence()->betaVector();
+    size_t horzDepth = vp->coordinateSystem()->horizontalDimensionIdx() == VizProperties::NO_DIMENSION ?
+          VizProperties::NO_DIMENSION :
+          vp->occurrence()->depth(vp->coordinateSystem()->horizontalDimensionIdx());
+    size_t vertDepth = vp->coordinateSystem()->verticalDimensionIdx() == VizProperties::NO_DIMENSION ?
+          VizProperties::NO_DIMENSION :
+          vp->occurrence()->depth(vp->coordinateSystem()->verticalDimensionIdx());
+    bool oneDimensional = vp->occurrence()->dimensionality() < vp->coordinateSystem()->verticalDimensionIdx();
+    bool zeroDimensional = vp->occurrence()->dimensionality() < vp->coordinateSystem()->horizontalDimensionIdx();
+    if (!zeroDimensional && horzOffset != 0) {
+      group.transformations.push_back(Transformation::constantShift(beta, horzDepth, -horzOffset));
+    }
+    if (!oneDimensional && vertOffset != 0) {
+      group.transformations.push_back(Transformation::constantShift(beta, vertDepth, -vertOffset));
+    }
   }
+  return group;
+}
+
+void VizManipulationManager::previewLegality(const std::vector<VizPolyhedron *> &polyhedra,
+                                             const TransformationGroup &group) {
+  std::pair<int, int> displacement(m_horzOffset, m_vertOffset);
+  if (displacement == m_previewDisplacement)
+    return;
+  m_previewDisplacement = displacement;
+  m_previewPolyhedra = polyhedra;
+
+  // Displacements already reached during this drag are not checked again.
+  if (m_previewResults.find(displacement) == m_previewResults.end() &&
+      !group.transformations.empty() && !polyhedra.empty()) {
+    m_previewScop = polyhedra.front()->scop();
+    connect(m_previewScop, &ClintScop::legalityPreviewed,
+            this, &VizManipulationManager::legalityPreviewed, Qt::UniqueConnection);
+    m_previewRequest = displacement;
+    m_previewGeneration = m_previewScop->previewLegality(group);
+  }
+  showLegalityPreview();
+}
+
+void VizManipulationManager::legalityPreviewed(unsigned generation, bool legal) {
+  if (generation != m_previewGeneration || m_previewScop == nullptr)
+    return;
+  m_previewResults[m_previewRequest] = legal;
+  showLegalityPreview();
+}
+
+void VizManipulationManager::showLegalityPreview() {
+  auto found = m_previewResults.find(m_previewDisplacement);
+  VizPolyhedron::Legality legality = found == m_previewResults.end() ?
+        VizPolyhedron::Legality::Unknown :
+        (found->second ? VizPolyhedron::Legality::Legal : VizPolyhedron::Legality::Illegal);
+  for (VizPolyhedron *vp : m_previewPolyhedra) {
+    vp->setLegalityPreview(legality);
+  }
+}
+
+void VizManipulationManager::endLegalityPreview() {
+  for (VizPolyhedron *vp : m_previewPolyhedra) {
+    vp->setLegalityPreview(VizPolyhedron::Legality::Unknown);
+  }
+  if (m_previewScop != nullptr) {
+    m_previewScop->cancelLegalityPreview();
+  }
+  m_previewPolyhedra.clear();
+  m_previewResults.clear();
+  m_previewDisplacement = std::make_pair(INT_MAX, INT_MAX);
+  m_previewScop = nullptr;
 }
 
 void VizManipulationManager::polyhedronHasMoved(VizPolyhedron *polyhedron) {
   CLINT_ASSERT(m_polyhedron == polyhedron, "Signaled end of polyhedron movement that was never initiated");
   m_polyhedron = nullptr;
   m_firstMovement = false;
+  endLegalityPreview();
   TransformationGroup group;
   const std::unordered_set<VizPolyhedron *> &selectedPolyhedra =
       polyhedron->coordinateSystem()->projection()->selectionManager()->selectedPolyhedra();
@@ -104,26 +182,10 @@ void VizManipulationManager::polyhedronHasMoved(VizPolyhedron *polyhedron) {
     CLINT_ASSERT(std::find(std::begin(selectedPolyhedra), std::end(selectedPolyhedra), polyhedron) != std::end(selectedPolyhedra),
                  "The active polyhedra is not selected");
 
+    group = movementGroup(selectedPolyhedra, m_horzOffset, m_vertOffset);
     for (VizPolyhedron *vp : selectedPolyhedra) {
-      const std::vector<int> beta = vp->occurrence()->betaVector();
-      size_t horzDepth = vp->coordinateSystem()->horizontalDimensionIdx() == VizProperties::NO_DIMENSION ?
-            VizProperties::NO_DIMENSION :
-            vp->occurrence()->depth(vp->coordinateSystem()->horizontalDimensionIdx());
-      int horzAmount = m_horzOffset;
-      size_t vertDepth = vp->coordinateSystem()->verticalDimensionIdx() == VizProperties::NO_DIMENSION ?
-            VizProperties::NO_DIMENSION :
-            vp->occurrence()->depth(vp->coordinateSystem()->verticalDimensionIdx());
-      int vertAmount = m_vertOffset;
       bool oneDimensional = vp->occurrence()->dimensionality() < vp->coordinateSystem()->verticalDimensionIdx();
       bool zeroDimensional = vp->occurrence()->dimensionality() < vp->coordinateSystem()->horizontalDimensionIdx();
-      if (!zeroDimensional && m_horzOffset != 0) {
-        Transformation transformation = Transformation::constantShift(beta, horzDepth, -horzAmount);
-        group.transformations.push_back(transformation);
-      }
-      if (!oneDimensional && m_vertOffset != 0) {
-        Transformation transformation = Transformation::constantShift(beta, vertDepth, -vertAmount);
-        group.transformations.push_back(transformation);
-      }
 
       int hmin, hmax, vmin, vmax;
       vp->coordinateSystem()->minMax(hmin, hmax, vmin, vmax);
@@ -161,9 +223,12 @@ void VizManipulationManager::polyhedronHasMoved(VizPolyhedron *polyhedron) {
   }
 
   if (!group.transformations.empty()) {
+    QPointer<VizProjection> projection = polyhedron->coordinateSystem()->projection();
     polyhedron->scop()->transform(group);
-    polyhedron->scop()->executeTransformationSequence();
-    polyhedron->coordinateSystem()->projection()->updateInnerDependences();
+    polyhedron->scop()->executeTransformationSequenceAsync([projection]() {
+      if (projection)
+        projection->updateInnerDependences();
+    });
   }
 }
 
@@ -825,6 +890,7 @@ void VizManipulationManager::polyhedronAboutToResize(VizPolyhedron *polyhedron,
   CLINT_ASSERT(polyhedron != nullptr, "cannot resize null polyhedron");
   m_polyhedron = polyhedron;
   m_direction = direction;
+  endLegalityPreview();
 
   // Do not allow multiple polyhedra resize yet.  This would require creating a graphicsGroup
   // and adding handles for the group to ensure UI consistency.
@@ -881,6 +947,8 @@ void VizManipulationManager::polyhedronAboutToResize(VizPolyhedron *polyhedron,
     } else {
       m_creatingDimension = 0;
       m_resizing = true;
+      // The scop does not change during the drag, guess the previous grain only once.
+      m_preGrainAmount = preGrainAmount(polyhedron);
     }
   } else {
     m_creatingDimension = 0;
@@ -941,52 +1009,99 @@ void VizManipulationManager::polyhedronHasResized(VizPolyhedron *polyhedron) {
     return;
   }
   m_resizing = false;
+  endLegalityPreview();
+
+  int preGrainAmount = m_preGrainAmount;
+  int grainAmount;
+  TransformationGroup group = resizeGroup(polyhedron, m_horzOffset, m_vertOffset, preGrainAmount, grainAmount);
+  int horizontalRange = (m_polyhedron->localHorizontalMax() - m_polyhedron->localHorizontalMin());
+  int verticalRange   = (m_polyhedron->localVerticalMax() - m_polyhedron->localVerticalMin());
+
+  if (!group.transformations.empty()) {
+    // Updating coordinate systems so that the scaled polyhedra fit inside.
+    if (m_direction == Dir::RIGHT || m_direction == Dir::LEFT) {
+      if (grainAmount > 0 && grainAmount > preGrainAmount) {
+        m_polyhedron->coordinateSystem()->projection()->ensureFitsHorizontally(
+              m_polyhedron->coordinateSystem(),
+              m_polyhedron->localHorizontalMax() + horizontalRange * (grainAmount - preGrainAmount) / preGrainAmount,
+              m_polyhedron->localHorizontalMax() + horizontalRange * (grainAmount - preGrainAmount) / preGrainAmount);
+      } else if (grainAmount < 0 && grainAmount < -preGrainAmount) {
+        m_polyhedron->coordinateSystem()->projection()->ensureFitsHorizontally(
+              m_polyhedron->coordinateSystem(),
+              m_polyhedron->localHorizontalMin() - horizontalRange * (grainAmount - preGrainAmount) / preGrainAmount,
+              m_polyhedron->localHorizontalMin() - horizontalRange * (grainAmount - preGrainAmount) / preGrainAmount);
+      }
+    }
+
+    if (m_direction == Dir::UP || m_direction == Dir::DOWN) {
+      if (grainAmount > 0 && grainAmount > preGrainAmount) {
+        m_polyhedron->coordinateSystem()->projection()->ensureFitsVertically(
+              m_polyhedron->coordinateSystem(),
+              m_polyhedron->localVerticalMax() + verticalRange * (grainAmount - preGrainAmount) / preGrainAmount,
+              m_polyhedron->localVerticalMax() + verticalRange * (grainAmount - preGrainAmount) / preGrainAmount);
+      } else if (grainAmount < 0 && grainAmount < -preGrainAmount) {
+        m_polyhedron->coordinateSystem()->projection()->ensureFitsVertically(
+              m_polyhedron->coordinateSystem(),
+              m_polyhedron->localVerticalMin() - verticalRange * (grainAmount - preGrainAmount) / preGrainAmount,
+              m_polyhedron->localVerticalMin() - verticalRange * (grainAmount - preGrainAmount) / preGrainAmount);
+      }
+    }
 
-  bool isHorizontal;
-  if (m_direction == Dir::LEFT || m_direction == Dir::RIGHT) {
-    isHorizontal = true;
-  } else if (m_direction == Dir::UP || m_direction == Dir::DOWN) {
-    isHorizontal = false;
+    QPointer<VizPolyhedron> resized = m_polyhedron;
+    m_polyhedron->occurrence()->scop()->transform(group);
+    m_polyhedron->occurrence()->scop()->executeTransformationSequenceAsync([resized]() {
+      if (resized)
+        resized->updateShape();
+    });
+    m_polyhedron->updateShape();
   } else {
-    CLINT_UNREACHABLE;
+    // Fix to the original position
+    m_polyhedron->coordinateSystem()->resetPolyhedronPos(polyhedron);
+    m_polyhedron->updateShape();
   }
 
-  // Examine if grain was already done and that regrain is possible.
-  size_t horizontalDimIdx = polyhedron->coordinateSystem()->horizontalDimensionIdx();
-  size_t verticalDimIdx   = polyhedron->coordinateSystem()->verticalDimensionIdx();
-  size_t horizontalDepth = horizontalDimIdx != VizProperties::NO_DIMENSION ?
-        polyhedron->occurrence()->depth(horizontalDimIdx) :
-        VizProperties::NO_DIMENSION;
-  size_t verticalDepth   = verticalDimIdx != VizProperties::NO_DIMENSION ?
-        polyhedron->occurrence()->depth(verticalDimIdx) :
+  m_polyhedron = nullptr;
+}
+
+// Depth of the loop along the resized dimension.
+size_t VizManipulationManager::resizedDepth(VizPolyhedron *polyhedron) const {
+  size_t dimIdx = (m_direction == Dir::LEFT || m_direction == Dir::RIGHT) ?
+        polyhedron->coordinateSystem()->horizontalDimensionIdx() :
+        polyhedron->coordinateSystem()->verticalDimensionIdx();
+  return dimIdx != VizProperties::NO_DIMENSION ?
+        polyhedron->occurrence()->depth(dimIdx) :
         VizProperties::NO_DIMENSION;
-  size_t depth;
-  if (m_direction == Dir::LEFT || m_direction == Dir::RIGHT) {
-    depth = horizontalDepth;
-  } else {
-    depth = verticalDepth;
-  }
-  Transformation densify = Transformation::densify(m_polyhedron->occurrence()->betaVector(),
-                                                   depth);
-  boost::optional<Transformation> inverse = m_polyhedron->occurrence()->scop()->guessInverseTransformation(densify);
-  int preGrainAmount = inverse ? inverse.get().constantAmount() : 1;
+}
 
-  int horizontalRange = (m_polyhedron->localHorizontalMax() - m_polyhedron->localHorizontalMin());
-  int verticalRange   = (m_polyhedron->localVerticalMax() - m_polyhedron->localVerticalMin());
+// Grain of the resized dimension before the resize, guessed by Clay from the applied scop.
+int VizManipulationManager::preGrainAmount(VizPolyhedron *polyhedron) const {
+  // Examine if grain was already done and that regrain is possible.
+  Transformation densify = Transformation::densify(polyhedron->occurrence()->betaVector(),
+                                                   resizedDepth(polyhedron));
+  boost::optional<Transformation> inverse = polyhedron->occurrence()->scop()->guessInverseTransformation(densify);
+  return inverse ? inverse.get().constantAmount() : 1;
+}
+
+// Signed grain amount is reported for the coordinate system update, the group is empty if the
+// polyhedron keeps its size.
+TransformationGroup VizManipulationManager::resizeGroup(VizPolyhedron *polyhedron, int horzOffset, int vertOffset,
+                                                        int preGrainAmount, int &grainAmount) {
+  size_t depth = resizedDepth(polyhedron);
+  int horizontalRange = (polyhedron->localHorizontalMax() - polyhedron->localHorizontalMin());
+  int verticalRange   = (polyhedron->localVerticalMax() - polyhedron->localVerticalMin());
 
-  int grainAmount;
   switch (m_direction) {
   case Dir::LEFT:
-    grainAmount = -round(static_cast<double>(m_horzOffset) * preGrainAmount / horizontalRange) + preGrainAmount;
+    grainAmount = -round(static_cast<double>(horzOffset) * preGrainAmount / horizontalRange) + preGrainAmount;
     break;
   case Dir::RIGHT:
-    grainAmount = round(static_cast<double>(m_horzOffset) * preGrainAmount / horizontalRange) + preGrainAmount;
+    grainAmount = round(static_cast<double>(horzOffset) * preGrainAmount / horizontalRange) + preGrainAmount;
     break;
   case Dir::UP:
-    grainAmount = -round(static_cast<double>(m_vertOffset) * preGrainAmount / verticalRange) + preGrainAmount;
+    grainAmount = -round(static_cast<double>(vertOffset) * preGrainAmount / verticalRange) + preGrainAmount;
     break;
   case Dir::DOWN:
-    grainAmount = round(static_cast<double>(m_vertOffset) * preGrainAmount / verticalRange) + preGrainAmount;
+    grainAmount = round(static_cast<double>(vertOffset) * preGrainAmount / verticalRange) + preGrainAmount;
     break;
   }
 
@@ -997,15 +1112,15 @@ void VizManipulationManager::polyhedronHasResized(VizPolyhedron *polyhedron) {
     reverse = true;
     int dimension, halfShiftAmount;
     if (m_direction == Dir::LEFT || m_direction == Dir::RIGHT) {
-      dimension = m_polyhedron->coordinateSystem()->horizontalDimensionIdx() + 1;
+      dimension = polyhedron->coordinateSystem()->horizontalDimensionIdx() + 1;
       halfShiftAmount = m_direction == Dir::RIGHT ?
-            m_polyhedron->localHorizontalMin() :
-            m_polyhedron->localHorizontalMax();
+            polyhedron->localHorizontalMin() :
+            polyhedron->localHorizontalMax();
     } else {
-      dimension = m_polyhedron->coordinateSystem()->verticalDimensionIdx() + 1;
+      dimension = polyhedron->coordinateSystem()->verticalDimensionIdx() + 1;
       halfShiftAmount = m_direction == Dir::UP ?
-            m_polyhedron->localVerticalMin() :
-            m_polyhedron->localVerticalMax();
+            polyhedron->localVerticalMin() :
+            polyhedron->localVerticalMax();
     }
     group.transformations.push_back(Transformation::reverse(
                                       polyhedron->occurrence()->betaVector(),
@@ -1020,88 +1135,50 @@ void VizManipulationManager::polyhedronHasResized(VizPolyhedron *polyhedron) {
   }
 
   if (preGrainAmount != 1 && preGrainAmount != grainAmount) {
-    group.transformations.push_back(densify);
+    group.transformations.push_back(Transformation::densify(polyhedron->occurrence()->betaVector(), depth));
   }
 
   if (grainAmount > 1 && preGrainAmount != grainAmount) {
     if (m_direction == Dir::LEFT || m_direction == Dir::RIGHT) {
       group.transformations.push_back(Transformation::grain(
                                         polyhedron->occurrence()->betaVector(),
-                                        horizontalDepth,
+                                        depth,
                                         grainAmount));
 
-      if (m_polyhedron->localHorizontalMin() != 0 && m_direction == Dir::RIGHT) {
+      if (polyhedron->localHorizontalMin() != 0 && m_direction == Dir::RIGHT) {
         group.transformations.push_back(Transformation::constantShift(
                                           polyhedron->occurrence()->betaVector(),
-                                          horizontalDepth,
-                                          m_polyhedron->localHorizontalMin() * (grainAmount - 1)));
-      } else if (m_polyhedron->localHorizontalMax() != 0 && m_direction == Dir::LEFT) {
+                                          depth,
+                                          polyhedron->localHorizontalMin() * (grainAmount - 1)));
+      } else if (polyhedron->localHorizontalMax() != 0 && m_direction == Dir::LEFT) {
         group.transformations.push_back(Transformation::constantShift(
                                           polyhedron->occurrence()->betaVector(),
-                                          horizontalDepth,
-                                          m_polyhedron->localHorizontalMax() * (grainAmount - 1)));
+                                          depth,
+                                          polyhedron->localHorizontalMax() * (grainAmount - 1)));
       }
     } else if (m_direction == Dir::DOWN || m_direction == Dir::UP) {
       group.transformations.push_back(Transformation::grain(
                                         polyhedron->occurrence()->betaVector(),
-                                        verticalDepth,
+                                        depth,
                                         grainAmount));
 
-      if (m_polyhedron->localVerticalMin() != 0 && m_direction == Dir::UP) {
+      if (polyhedron->localVerticalMin() != 0 && m_direction == Dir::UP) {
         group.transformations.push_back(Transformation::constantShift(
                                           polyhedron->occurrence()->betaVector(),
-                                          verticalDepth,
-                                          m_polyhedron->localVerticalMin() * (grainAmount - 1)));
-      } else if (m_polyhedron->localVerticalMax() != 0 && m_direction == Dir::DOWN) {
+                                          depth,
+                                          polyhedron->localVerticalMin() * (grainAmount - 1)));
+      } else if (polyhedron->localVerticalMax() != 0 && m_direction == Dir::DOWN) {
         group.transformations.push_back(Transformation::constantShift(
                                           polyhedron->occurrence()->betaVector(),
-                                          verticalDepth,
-                                          m_polyhedron->localVerticalMax() * (grainAmount - 1)));
+                                          depth,
+                                          polyhedron->localVerticalMax() * (grainAmount - 1)));
       }
     }
   }
 
-  if (!group.transformations.empty()) {
-    if (reverse) grainAmount = -grainAmount;
-    // Updating coordinate systems so that the scaled polyhedra fit inside.
-    if (m_direction == Dir::RIGHT || m_direction == Dir::LEFT) {
-      if (grainAmount > 0 && grainAmount > preGrainAmount) {
-        m_polyhedron->coordinateSystem()->projection()->ensureFitsHorizontally(
-              m_polyhedron->coordinateSystem(),
-              m_polyhedron->localHorizontalMax() + horizontalRange * (grainAmount - preGrainAmount) / preGrainAmount,
-              m_polyhedron->localHorizontalMax() + horizontalRange * (grainAmount - preGrainAmount) / preGrainAmount);
-      } else if (grainAmount < 0 && grainAmount < -preGrainAmount) {
-        m_polyhedron->coordinateSystem()->projection()->ensureFitsHorizontally(
-              m_polyhedron->coordinateSystem(),
-              m_polyhedron->localHorizontalMin() - horizontalRange * (grainAmount - preGrainAmount) / preGrainAmount,
-              m_polyhedron->localHorizontalMin() - horizontalRange * (grainAmount - preGrainAmount) / preGrainAmount);
-      }
-    }
-
-    if (m_direction == Dir::UP || m_direction == Dir::DOWN) {
-      if (grainAmount > 0 && grainAmount > preGrainAmount) {
-        m_polyhedron->coordinateSystem()->projection()->ensureFitsVertically(
-              m_polyhedron->coordinateSystem(),
-              m_polyhedron->localVerticalMax() + verticalRange * (grainAmount - preGrainAmount) / preGrainAmount,
-              m_polyhedron->localVerticalMax() + verticalRange * (grainAmount - preGrainAmount) / preGrainAmount);
-      } else if (grainAmount < 0 && grainAmount < -preGrainAmount) {
-        m_polyhedron->coordinateSystem()->projection()->ensureFitsVertically(
-              m_polyhedron->coordinateSystem(),
-              m_polyhedron->localVerticalMin() - verticalRange * (grainAmount - preGrainAmount) / preGrainAmount,
-              m_polyhedron->localVerticalMin() - verticalRange * (grainAmount - preGrainAmount) / preGrainAmount);
-      }
-    }
-
-    m_polyhedron->occurrence()->scop()->transform(group);
-    m_polyhedron->occurrence()->scop()->executeTransformationSequence();
-    m_polyhedron->updateShape();
-  } else {
-    // Fix to the original position
-    m_polyhedron->coordinateSystem()->resetPolyhedronPos(polyhedron);
-    m_polyhedron->updateShape();
-  }
-
-  m_polyhedron = nullptr;
+  if (reverse)
+    grainAmount = -grainAmount;
+  return group;
 }
 
 void VizManipulationManager::polyhedronResizing(QPointF displacement) {
@@ -1170,12 +1247,18 @@ void VizManipulationManager::polyhedronResizing(QPointF displacement) {
           m_polyhedron->localVerticalMin() - m_vertOffset);
     m_polyhedron->prepareExtendDown(-displacement.y());
   }
+
+  if (std::make_pair(m_horzOffset, m_vertOffset) != m_previewDisplacement) {
+    int grainAmount;
+    previewLegality({m_polyhedron}, resizeGroup(m_polyhedron, m_horzOffset, m_vertOffset, m_preGrainAmount, grainAmount));
+  }
 }
 
 void VizManipulationManager::polyhedronAboutToSkew(VizPolyhedron *polyhedron, int corner) {
   CLINT_ASSERT(polyhedron != nullptr, "cannot resize null polyhedron");
   m_polyhedron = polyhedron;
   m_corner = corner;
+  endLegalityPreview();
 
   // Do not allow multiple polyhedra skew yet.  This would require creating a graphicsGroup
   // and adding handles for the group to ensure UI consistency.
@@ -1198,26 +1281,45 @@ void VizManipulationManager::polyhedronHasSkewed(VizPolyhedron *polyhedron) {
   if (!m_skewing)
     return;
   m_skewing = false;
+  endLegalityPreview();
 
+  TransformationGroup group = skewGroup(polyhedron, m_horzOffset, m_vertOffset);
+  if (group.transformations.empty()) {
+    m_polyhedron->resetPointPositions();
+    m_polyhedron->updateShape();
+    m_polyhedron->coordinateSystem()->resetPolyhedronPos(polyhedron);
+    m_polyhedron = nullptr;
+    return;
+  }
+
+  QPointer<VizPolyhedron> skewed = m_polyhedron;
+  m_polyhedron->occurrence()->scop()->transform(group);
+  m_polyhedron->occurrence()->scop()->executeTransformationSequenceAsync([skewed]() {
+    if (skewed)
+      skewed->updateShape();
+  });
+  m_polyhedron->updateShape();
+
+  m_polyhedron = nullptr;
+}
+
+TransformationGroup VizManipulationManager::skewGroup(VizPolyhedron *polyhedron, int horzOffset, int vertOffset) {
   // Max is inclusive, so we would need +1 here, but we would also need -1 before division to compute the skew factor
-  int horizontalRange = (m_polyhedron->localHorizontalMax() - m_polyhedron->localHorizontalMin());
-  int verticalRange   = (m_polyhedron->localVerticalMax() - m_polyhedron->localVerticalMin());
+  int horizontalRange = (polyhedron->localHorizontalMax() - polyhedron->localHorizontalMin());
+  int verticalRange   = (polyhedron->localVerticalMax() - polyhedron->localVerticalMin());
 
   int horizontalPreShiftAmount = m_corner & C_RIGHT ?
-        m_polyhedron->localHorizontalMin() :
-        m_polyhedron->localHorizontalMax();
+        polyhedron->localHorizontalMin() :
+        polyhedron->localHorizontalMax();
   int verticalPreShiftAmount = m_corner & C_BOTTOM ?
-        m_polyhedron->localVerticalMax() :
-        m_polyhedron->localVerticalMin();
+        polyhedron->localVerticalMax() :
+        polyhedron->localVerticalMin();
 
-  int verticalSkewFactor = horizontalRange == 0 ? 0 : round(static_cast<double>(-m_vertOffset) / horizontalRange);
-  int horizontalSkewFactor = verticalRange == 0 ? 0 : round(static_cast<double>(m_horzOffset) / verticalRange);
+  int verticalSkewFactor = horizontalRange == 0 ? 0 : round(static_cast<double>(-vertOffset) / horizontalRange);
+  int horizontalSkewFactor = verticalRange == 0 ? 0 : round(static_cast<double>(horzOffset) / verticalRange);
+  TransformationGroup group;
   if (verticalSkewFactor == 0 && horizontalSkewFactor == 0) {
-    m_polyhedron->resetPointPositions();
-    m_polyhedron->updateShape();
-    m_polyhedron->coordinateSystem()->resetPolyhedronPos(polyhedron);
-    m_polyhedron = nullptr;
-    return;
+    return group;
   }
 
   if (!(m_corner & C_RIGHT)) verticalSkewFactor = -verticalSkewFactor;
@@ -1232,62 +1334,49 @@ void VizManipulationManager::polyhedronHasSkewed(VizPolyhedron *polyhedron) {
         polyhedron->occurrence()->depth(verticalDimIdx) :
         VizProperties::NO_DIMENSION;
 
-  TransformationGroup group;
-  if (verticalSkewFactor != 0 || horizontalSkewFactor != 0) {
-    if (horizontalPreShiftAmount != 0) {
-      group.transformations.push_back(Transformation::constantShift(
-                                        m_polyhedron->occurrence()->betaVector(),
-                                        horizontalDepth,
-                                        horizontalPreShiftAmount));
-    }
-    if (verticalPreShiftAmount != 0) {
-      group.transformations.push_back(Transformation::constantShift(
-                                        m_polyhedron->occurrence()->betaVector(),
-                                        verticalDepth,
-                                        verticalPreShiftAmount));
-    }
-
-    // vertical
-    if (verticalSkewFactor != 0) {
-      group.transformations.push_back(Transformation::reshape(
-                                        m_polyhedron->occurrence()->betaVector(),
-                                        verticalDepth,
-                                        polyhedron->coordinateSystem()->horizontalDimensionIdx() + 1,
-                                        -verticalSkewFactor));
-    }
-    // horizontal
-    if (horizontalSkewFactor != 0) {
-      group.transformations.push_back(Transformation::reshape(
-                                        m_polyhedron->occurrence()->betaVector(),
-                                        horizontalDepth,
-                                        polyhedron->coordinateSystem()->verticalDimensionIdx() + 1, // input dim is not subject to tiling
-                                        -horizontalSkewFactor));
-    }
-
-    if (horizontalPreShiftAmount != 0) {
-      group.transformations.push_back(Transformation::constantShift(
-                                        m_polyhedron->occurrence()->betaVector(),
-                                        horizontalDepth,
-                                        -horizontalPreShiftAmount));
-    }
-    if (verticalPreShiftAmount != 0) {
-      group.transformations.push_back(Transformation::constantShift(
-                                        m_polyhedron->occurrence()->betaVector(),
-                                        verticalDepth,
-                                        -verticalPreShiftAmount));
-    }
+  if (horizontalPreShiftAmount != 0) {
+    group.transformations.push_back(Transformation::constantShift(
+                                      polyhedron->occurrence()->betaVector(),
+                                      horizontalDepth,
+                                      horizontalPreShiftAmount));
+  }
+  if (verticalPreShiftAmount != 0) {
+    group.transformations.push_back(Transformation::constantShift(
+                                      polyhedron->occurrence()->betaVector(),
+                                      verticalDepth,
+                                      verticalPreShiftAmount));
   }
 
-  if (!group.transformations.empty()) {
-    m_polyhedron->occurrence()->scop()->transform(group);
-    m_polyhedron->occurrence()->scop()->executeTransformationSequence();
-  } else {
-    // Fix to the original position
-    m_polyhedron->coordinateSystem()->resetPolyhedronPos(polyhedron);
+  // vertical
+  if (verticalSkewFactor != 0) {
+    group.transformations.push_back(Transformation::reshape(
+                                      polyhedron->occurrence()->betaVector(),
+                                      verticalDepth,
+                                      polyhedron->coordinateSystem()->horizontalDimensionIdx() + 1,
+                                      -verticalSkewFactor));
+  }
+  // horizontal
+  if (horizontalSkewFactor != 0) {
+    group.transformations.push_back(Transformation::reshape(
+                                      polyhedron->occurrence()->betaVector(),
+                                      horizontalDepth,
+                                      polyhedron->coordinateSystem()->verticalDimensionIdx() + 1, // input dim is not subject to tiling
+                                      -horizontalSkewFactor));
   }
-  m_polyhedron->updateShape();
 
-  m_polyhedron = nullptr;
+  if (horizontalPreShiftAmount != 0) {
+    group.transformations.push_back(Transformation::constantShift(
+                                      polyhedron->occurrence()->betaVector(),
+                                      horizontalDepth,
+                                      -horizontalPreShiftAmount));
+  }
+  if (verticalPreShiftAmount != 0) {
+    group.transformations.push_back(Transformation::constantShift(
+                                      polyhedron->occurrence()->betaVector(),
+                                      verticalDepth,
+                                      -verticalPreShiftAmount));
+  }
+  return group;
 }
 
 void VizManipulationManager::polyhedronSkewing(QPointF displacement) {
@@ -1321,6 +1410,8 @@ void VizManipulationManager::polyhedronSkewing(QPointF displacement) {
       m_polyhedron->prepareSkewHorizontalTop(displacement.x());
     }
   }
+
+  previewLegality({m_polyhedron}, skewGroup(m_polyhedron, m_horzOffset, m_vertOffset));
 }
 
 void VizManipulationManager::polyhedronAboutToRotate(VizPolyhedron *polyhedron, int corner) {
@@ -4,6 +4,12 @@
 #include <QObject>
 #include <QPointF>
 
+#include <climits>
+#include <map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 class VizPolyhedron;
 class VizPoint;
 class VizCoordinateSystem;
@@ -73,6 +79,9 @@ public slots:
   void polyhedronRotating(QPointF displacement);
   void polyhedronHasRotated(VizPolyhedron *polyhedron);
 
+private slots:
+  void legalityPreviewed(unsigned generation, bool legal);
+
 private:
   VizPolyhedron *m_polyhedron = nullptr;
   VizPoint *m_point = nullptr;
@@ -88,6 +97,7 @@ private:
   double m_rotationAngle;
   bool m_skewing = false;
   bool m_resizing = false;
+  int m_preGrainAmount = 1;
   int m_creatingDimension = 0;
 
   enum {
@@ -112,6 +122,26 @@ private:
   }
 
   void remapBetas(TransformationGroup group, ClintScop *scop);
+
+  TransformationGroup movementGroup(const std::unordered_set<VizPolyhedron *> &polyhedra, int horzOffset, int vertOffset);
+  TransformationGroup skewGroup(VizPolyhedron *polyhedron, int horzOffset, int vertOffset);
+  size_t resizedDepth(VizPolyhedron *polyhedron) const;
+  int preGrainAmount(VizPolyhedron *polyhedron) const;
+  TransformationGroup resizeGroup(VizPolyhedron *polyhedron, int horzOffset, int vertOffset,
+                                  int preGrainAmount, int &grainAmount);
+
+  // Legality of the transformation being dragged, checked in background and memoized per
+  // displacement for the duration of the drag.
+  std::map<std::pair<int, int>, bool> m_previewResults;
+  std::pair<int, int> m_previewDisplacement = {INT_MAX, INT_MAX};
+  std::pair<int, int> m_previewRequest;
+  unsigned m_previewGeneration = 0;
+  std::vector<VizPolyhedron *> m_previewPolyhedra;
+  ClintScop *m_previewScop = nullptr;
+
+  void previewLegality(const std::vector<VizPolyhedron *> &polyhedra, const TransformationGroup &group);
+  void showLegalityPreview();
+  void endLegalityPreview();
 };
 
 #endif // VIZMANIPULATIONMANAGER_H
@@ -11,6 +11,7 @@
 #include <QtWidgets>
 
 #include <algorithm>
+#include <cmath>
 #include <vector>
 
 VizPolyhedron::VizPolyhedron(ClintStmtOccurrence *occurrence, VizCoordinateSystem *vcs) :
@@ -72,22 +73,33 @@ void VizPolyhedron::resetPointPositions() {
 }
 
 bool VizPolyhedron::hasPoints() const {
-  return m_pts.size() != 0;
+  // Clipped polyhedra are never empty, they may just have no points in the viewport.
+  return m_clipped || m_pts.size() != 0;
 }
 
 void VizPolyhedron::reprojectPoints() {
   int horizontalDim = coordinateSystem()->horizontalDimensionIdx();
   int verticalDim   = coordinateSystem()->verticalDimensionIdx();
   CLINT_ASSERT(m_occurrence, "empty occurrence changed");
-  std::vector<std::vector<int>> points =
+  PointBuffer points = m_clipped ?
+      occurrence()->projectOn(horizontalDim, verticalDim, m_clipHorizontalRange, m_clipVerticalRange) :
       occurrence()->projectOn(horizontalDim, verticalDim);
 
+  m_densityPointCount = points.size();
+  m_densityBinSize = densityBinSize(points.size());
+  if (isAggregated()) {
+    points = aggregatePoints(points);
+  } else {
+    m_density.clear();
+    m_maxDensity = 0;
+  }
+
   PointMap updatedPoints, extraPoints;
   std::unordered_map<std::pair<int, int>,
                      VizPoint *,
                      boost::hash<std::pair<int, int>>> visibleScatteredCoordiantes;
 
-  for (const std::vector<int> &point : points) {
+  for (PointBuffer::Row point : points) {
     std::pair<int, int> scatteredCoordinates;
     std::vector<int> originalCoordinates;
     std::tie(originalCoordinates, scatteredCoordinates) =
@@ -105,6 +117,7 @@ void VizPolyhedron::reprojectPoints() {
         vp->setOriginalCoordinates(originalCoordinates);
       }
       vp->setScatteredCoordinates(scatteredCoordinates);
+      vp->setVisible(!isAggregated());
       updatedPoints.emplace(originalCoordinates, vp);
       visibleScatteredCoordiantes.emplace(scatteredCoordinates, vp);
     } else {
@@ -124,16 +137,121 @@ void VizPolyhedron::reprojectPoints() {
   m_pointOthers = extraPoints;
 }
 
+/// Size of the density grid bins for the given number of points, 0 to draw them individually.
+int VizPolyhedron::densityBinSize(size_t nbPoints) const {
+  VizProjection *projection = m_coordinateSystem->projection();
+  VizProperties *props = projection->vizProperties();
+  if (nbPoints <= static_cast<size_t>(props->pointBudget()))
+    return 0;
+
+  // Bins are at least densityCellSize pixels wide at the current zoom level, and there are
+  // no more of them than the point budget for a dense polyhedron.
+  double pixelsPerPoint = props->pointDistance() * projection->viewScale();
+  int zoomBinSize = static_cast<int>(std::ceil(props->densityCellSize() / pixelsPerPoint));
+  int budgetBinSize = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(nbPoints) / props->pointBudget())));
+  return std::max(1, std::max(zoomBinSize, budgetBinSize));
+}
+
+/// Count the points in the bins of the density grid.  Returns the first point of every
+/// non-empty bin, these are the only ones represented by VizPoints.
+PointBuffer VizPolyhedron::aggregatePoints(const PointBuffer &points) {
+  CLINT_ASSERT(m_densityBinSize > 0, "Aggregating points without the density grid");
+  if (points.empty()) {
+    m_density.clear();
+    m_maxDensity = 0;
+    return PointBuffer(points.stride());
+  }
+
+  int horizontalDim = coordinateSystem()->horizontalDimensionIdx();
+  int verticalDim   = coordinateSystem()->verticalDimensionIdx();
+  std::pair<int, int> scatteredCoordinates;
+  std::tie(std::ignore, scatteredCoordinates) =
+      m_occurrence->parseProjectedPoint(points.front(), horizontalDim, verticalDim);
+  const int horizontalMask = scatteredCoordinates.first != VizPoint::NO_COORD ? 1 : 0;
+  const int verticalMask   = scatteredCoordinates.second != VizPoint::NO_COORD ? 1 : 0;
+  const size_t horizontalColumn = 0;
+  const size_t verticalColumn   = horizontalMask;
+
+  // The grid spans the bounding box, or its visible part for clipped polyhedra.
+  std::pair<int, int> horizontalBounds, verticalBounds;
+  std::tie(horizontalBounds, verticalBounds) = m_occurrence->boundingBox(horizontalDim, verticalDim);
+  if (m_clipped) {
+    horizontalBounds.first  = std::max(horizontalBounds.first, m_clipHorizontalRange.first);
+    horizontalBounds.second = std::min(horizontalBounds.second, m_clipHorizontalRange.second);
+    verticalBounds.first    = std::max(verticalBounds.first, m_clipVerticalRange.first);
+    verticalBounds.second   = std::min(verticalBounds.second, m_clipVerticalRange.second);
+  }
+  m_densityHorizontalOrigin = horizontalMask * horizontalBounds.first;
+  m_densityVerticalOrigin   = verticalMask * verticalBounds.first;
+  m_densityColumns = horizontalMask * (horizontalBounds.second - horizontalBounds.first) / m_densityBinSize + 1;
+  int densityRows  = verticalMask * (verticalBounds.second - verticalBounds.first) / m_densityBinSize + 1;
+
+  // Bin index of every point, computed in a single branch-free pass over the flat buffer.
+  // Multiplying by the reciprocal of the bin size vectorizes, unlike the integer division;
+  // the half-coordinate offset keeps rounding errors away from the bin boundaries.
+  const size_t nbPoints = points.size();
+  const size_t stride = points.stride();
+  const PointBuffer::value_type *data = points.data();
+  const double binScale = 1.0 / m_densityBinSize;
+  const int horizontalOrigin = m_densityHorizontalOrigin;
+  const int verticalOrigin   = m_densityVerticalOrigin;
+  const int columns = m_densityColumns;
+  std::vector<int> bins(nbPoints);
+  for (size_t i = 0; i < nbPoints; ++i) {
+    int x = horizontalMask * (data[i * stride + horizontalColumn] - horizontalOrigin);
+    int y = verticalMask * (data[i * stride + verticalColumn] - verticalOrigin);
+    int column = static_cast<int>((x + 0.5) * binScale);
+    int row    = static_cast<int>((y + 0.5) * binScale);
+    bins[i] = row * columns + column;
+  }
+
+  m_density.assign(static_cast<size_t>(m_densityColumns) * densityRows, 0);
+  PointBuffer representatives(stride);
+  for (size_t i = 0; i < nbPoints; ++i) {
+    if (m_density[bins[i]]++ == 0) {
+      representatives.append(points[i]);
+    }
+  }
+  m_maxDensity = *std::max_element(std::begin(m_density), std::end(m_density));
+  return std::move(representatives);
+}
+
+/// Rebuild the density grid if the zoom level requires a different bin size.
+/// Returns true if the points changed.
+bool VizPolyhedron::updateLevelOfDetail() {
+  if (!isAggregated())
+    return false;
+  if (densityBinSize(m_densityPointCount) == m_densityBinSize)
+    return false;
+
+  reprojectPoints();
+  updateShape();
+  updateInternalDependences();
+  update();
+  return true;
+}
+
 void VizPolyhedron::occurrenceChanged() {
   int horizontalDim = coordinateSystem()->horizontalDimensionIdx();
   int verticalDim   = coordinateSystem()->verticalDimensionIdx();
   CLINT_ASSERT(m_occurrence, "empty occurrence changed");
+  std::pair<int, int> horizontalBounds, verticalBounds;
+  std::tie(horizontalBounds, verticalBounds) = m_occurrence->boundingBox(horizontalDim, verticalDim);
+  m_clipped = m_occurrence->boundingBoxSize(horizontalDim, verticalDim) >
+      m_coordinateSystem->projection()->vizProperties()->clippingThreshold();
+  if (m_clipped) {
+    // Extent is known without enumeration, set it first to map the viewport to the scattered coordinates.
+    recomputeMinMax();
+    std::tie(m_clipHorizontalRange, m_clipVerticalRange) =
+        visibleRanges(m_coordinateSystem->projection()->visibleSceneRect(),
+                      m_coordinateSystem->projection()->vizProperties()->clippingMargin());
+  }
   reprojectPoints();
   updateShape();
   m_coordinateSystem->projection()->ensureFitsHorizontally(
-        m_coordinateSystem, localHorizontalMin(), localHorizontalMax());
+        m_coordinateSystem, horizontalBounds.first, horizontalBounds.second);
   m_coordinateSystem->projection()->ensureFitsVertically(
-        m_coordinateSystem, localVerticalMin(), localVerticalMax());
+        m_coordinateSystem, verticalBounds.first, verticalBounds.second);
 
   // Create lines that symbolize tiles.
   VizProperties *props = coordinateSystem()->projection()->vizProperties();
@@ -170,6 +288,49 @@ void VizPolyhedron::occurrenceChanged() {
   updateHandlePositions();
 }
 
+/// Ranges of scattered coordinates visible in the scene rectangle, extended on each side
+/// by the margin relative to the rectangle size.
+std::pair<std::pair<int, int>, std::pair<int, int>>
+VizPolyhedron::visibleRanges(const QRectF &visibleSceneRect, double margin) const {
+  const double pointDistance =
+      m_coordinateSystem->projection()->vizProperties()->pointDistance();
+  QRectF rect = mapFromScene(visibleSceneRect).boundingRect();
+  rect.adjust(-rect.width() * margin, -rect.height() * margin,
+              rect.width() * margin, rect.height() * margin);
+
+  // Points are positioned at ((x - min) * distance, -(y - min) * distance) in item coordinates.
+  std::pair<int, int> horizontal(m_localHorizontalMin + static_cast<int>(std::floor(rect.left() / pointDistance)),
+                                 m_localHorizontalMin + static_cast<int>(std::ceil(rect.right() / pointDistance)));
+  std::pair<int, int> vertical(m_localVerticalMin + static_cast<int>(std::floor(-rect.bottom() / pointDistance)),
+                               m_localVerticalMin + static_cast<int>(std::ceil(-rect.top() / pointDistance)));
+  return std::make_pair(horizontal, vertical);
+}
+
+/// Re-enumerate the points of a clipped polyhedron if the visible part of the scene is
+/// no longer covered by the enumerated window.  Returns true if the points changed.
+bool VizPolyhedron::updateClipping(const QRectF &visibleSceneRect) {
+  if (!m_clipped)
+    return false;
+
+  std::pair<int, int> horizontal, vertical;
+  std::tie(horizontal, vertical) = visibleRanges(visibleSceneRect, 0.0);
+
+  bool covered = horizontal.first >= m_clipHorizontalRange.first &&
+      horizontal.second <= m_clipHorizontalRange.second &&
+      vertical.first >= m_clipVerticalRange.first &&
+      vertical.second <= m_clipVerticalRange.second;
+  if (covered)
+    return false;
+
+  std::tie(m_clipHorizontalRange, m_clipVerticalRange) =
+      visibleRanges(visibleSceneRect, m_coordinateSystem->projection()->vizProperties()->clippingMargin());
+  reprojectPoints();
+  updateShape();
+  updateInternalDependences();
+  update();
+  return true;
+}
+
 std::unordered_set<VizPoint *> VizPolyhedron::points() const {
   std::unordered_set<VizPoint *> result;
   for (auto it = std::begin(m_pts); it != std::end(m_pts); ++it) {
@@ -188,8 +349,8 @@ VizPoint *VizPolyhedron::point(const std::vector<int> &originalCoordinates) cons
   }
 }
 
-void VizPolyhedron::setInternalDependences(std::vector<std::vector<int>> &&dependences) {
-  vizDependenceArrowsCreate(this, this, std::forward<std::vector<std::vector<int>>>(dependences), false, this, m_deps);
+void VizPolyhedron::setInternalDependences(ClintDependence *dependence) {
+  vizDependenceArrowsCreate(this, this, dependence, false, this, m_deps);
 }
 
 void VizPolyhedron::updateInternalDependences() {
@@ -201,8 +362,7 @@ void VizPolyhedron::updateInternalDependences() {
   m_deps.clear();
 
   for (ClintDependence *dependence : m_occurrence->scop()->internalDependences(m_occurrence)) {
-    setInternalDependences(dependence->projectOn(coordinateSystem()->horizontalDimensionIdx(),
-                                                 coordinateSystem()->verticalDimensionIdx()));
+    setInternalDependences(dependence);
   }
 }
 
@@ -376,6 +536,19 @@ QPolygonF VizPolyhedron::computePolygon() const {
 void VizPolyhedron::recomputeShape() {
   const double pointDistance =
       m_coordinateSystem->projection()->vizProperties()->pointDistance();
+
+  // Only a part of the points is known for clipped polyhedra, use their bounding box.
+  if (m_clipped) {
+    m_polyhedronShape = QPainterPath();
+    m_polyhedronShape.addRoundedRect(-pointDistance / 2.0,
+                                     -(m_localVerticalMax - m_localVerticalMin + 0.5) * pointDistance,
+                                     (m_localHorizontalMax - m_localHorizontalMin + 1) * pointDistance,
+                                     (m_localVerticalMax - m_localVerticalMin + 1) * pointDistance,
+                                     pointDistance / 4.0,
+                                     pointDistance / 4.0);
+    return;
+  }
+
   std::vector<VizPoint *> points = convexHull();
   m_polyhedronShape = QPainterPath();
 
@@ -448,11 +621,34 @@ void VizPolyhedron::paint(QPainter *painter, const QStyleOptionGraphicsItem *opt
     fatPen.setWidth(painter->pen().widthF() * 2.0);
     painter->setPen(fatPen);
   }
+  if (m_legalityPreview != Legality::Unknown) {
+    QPen legalityPen = QPen(painter->pen());
+    legalityPen.setColor(m_legalityPreview == Legality::Legal ? Qt::darkGreen : Qt::red);
+    legalityPen.setWidthF(std::max(legalityPen.widthF(), 1.0) * 2.0);
+    painter->setPen(legalityPen);
+  }
   painter->setBrush(m_backgroundColor);
   painter->drawPath(m_polyhedronShape);
 
   painter->drawLines(m_tileLines.data(), m_tileLines.size());
 
+  if (isAggregated() && m_maxDensity != 0) {
+    const double pointDistance =
+        m_coordinateSystem->projection()->vizProperties()->pointDistance();
+    const double binSide = m_densityBinSize * pointDistance;
+    QColor binColor(Qt::black);
+    for (size_t bin = 0, e = m_density.size(); bin < e; ++bin) {
+      if (m_density[bin] == 0)
+        continue;
+      int column = bin % m_densityColumns;
+      int row    = bin / m_densityColumns;
+      double left   = (m_densityHorizontalOrigin + column * m_densityBinSize - m_localHorizontalMin - 0.5) * pointDistance;
+      double bottom = -(m_densityVerticalOrigin + row * m_densityBinSize - m_localVerticalMin - 0.5) * pointDistance;
+      binColor.setAlphaF(0.15 + 0.7 * m_density[bin] / m_maxDensity);
+      painter->fillRect(QRectF(left, bottom - binSide, binSide, binSide), binColor);
+    }
+  }
+
   painter->restore();
 }
 
@@ -611,6 +807,15 @@ void VizPolyhedron::reparentPoint(VizPoint *point) {
 }
 
 void VizPolyhedron::recomputeMinMax() {
+  if (m_clipped || isAggregated()) {
+    std::pair<int, int> horizontalBounds, verticalBounds;
+    std::tie(horizontalBounds, verticalBounds) =
+        m_occurrence->boundingBox(m_coordinateSystem->horizontalDimensionIdx(),
+                                  m_coordinateSystem->verticalDimensionIdx());
+    std::tie(m_localHorizontalMin, m_localHorizontalMax) = horizontalBounds;
+    std::tie(m_localVerticalMin, m_localVerticalMax) = verticalBounds;
+    return;
+  }
   int horizontalMin = INT_MAX, horizontalMax = INT_MIN,
       verticalMin = INT_MAX, verticalMax = INT_MIN;
   for (auto p : m_pts) {
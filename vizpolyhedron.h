@@ -17,6 +17,7 @@
 
 #include <boost/functional/hash.hpp>
 
+class ClintDependence;
 class VizPoint;
 class VizDepArrow;
 
@@ -64,7 +65,19 @@ public:
 
   void recomputeMinMax();
 
-  void setInternalDependences(std::vector<std::vector<int>> &&dependences);
+  /// Whether only the points around the viewport are enumerated, see VizProperties::clippingThreshold.
+  bool isClipped() const {
+    return m_clipped;
+  }
+  bool updateClipping(const QRectF &visibleSceneRect);
+
+  /// Whether the points are drawn as a density grid, see VizProperties::pointBudget.
+  bool isAggregated() const {
+    return m_densityBinSize != 0;
+  }
+  bool updateLevelOfDetail();
+
+  void setInternalDependences(ClintDependence *dependence);
   void resetPointPositions();
 
   void reparent(VizCoordinateSystem *vcs) {
@@ -99,6 +112,20 @@ public:
     update();
   }
 
+  /// Legality of the transformation being dragged, shown by the outline color.
+  enum class Legality {
+    Unknown,
+    Legal,
+    Illegal
+  };
+
+  void setLegalityPreview(Legality legality) {
+    if (legality == m_legalityPreview)
+      return;
+    m_legalityPreview = legality;
+    update();
+  }
+
   void setPos(const QPointF &position) {
     if (m_overrideSetPos) {
       m_pressPos = position;
@@ -113,6 +140,17 @@ public:
   VizPoint *point(const std::vector<int> &originalCoordinates) const;
   std::unordered_set<VizPoint *> points() const;
 
+  /// Call @p visitor on every point, including those projected at the same position as others.
+  template <typename Visitor>
+  void forEachPoint(Visitor visitor) const {
+    for (const auto &element : m_pts) {
+      visitor(element.second);
+    }
+    for (const auto &element : m_pointOthers) {
+      visitor(element.second);
+    }
+  }
+
   void reparentPoint(VizPoint *point);
   bool hasPoints() const;
 
@@ -163,6 +201,7 @@ private:
   VizCoordinateSystem *m_coordinateSystem;
   QPainterPath m_polyhedronShape;
   QColor m_backgroundColor;
+  Legality m_legalityPreview = Legality::Unknown;
 
   std::vector<VizHandle *> m_handles;
   bool m_hovered = false;
@@ -177,6 +216,25 @@ private:
   void reprojectPoints();
 
   std::unordered_set<VizDepArrow *> m_deps;
+
+  // Large polyhedra are enumerated only inside the window of scattered coordinates
+  // (inclusive ranges) around the viewport.  Their extent comes from closed-form bounds.
+  bool m_clipped = false;
+  std::pair<int, int> m_clipHorizontalRange;
+  std::pair<int, int> m_clipVerticalRange;
+
+  // Polyhedra with too many points are drawn as a grid of square bins of m_densityBinSize
+  // scattered coordinates, 0 if drawn point by point.  Only one point per bin is kept.
+  int m_densityBinSize = 0;
+  int m_densityHorizontalOrigin = 0;
+  int m_densityVerticalOrigin   = 0;
+  int m_densityColumns = 0;
+  size_t m_densityPointCount = 0;
+  std::vector<unsigned> m_density;
+  unsigned m_maxDensity = 0;
+
+  int densityBinSize(size_t nbPoints) const;
+  PointBuffer aggregatePoints(const PointBuffer &points);
   int m_localHorizontalMin = 0;
   int m_localVerticalMin   = 0;
   int m_localHorizontalMax = 0;
@@ -194,6 +252,8 @@ private:
   bool m_mouseEventForwarding = false;
 
   void setPointVisiblePos(VizPoint *vp, int x, int y);
+  std::pair<std::pair<int, int>, std::pair<int, int>> visibleRanges(const QRectF &visibleSceneRect,
+                                                                    double margin) const;
   static std::pair<int, int> pointScatteredCoordsReal(const VizPoint *vp);
   std::vector<VizPoint *> convexHull() const;
   QPolygonF computePolygon() const;
@@ -17,6 +17,7 @@ VizProjection::VizProjection(int horizontalDimensionIdx, int verticalDimensionId
   m_scene = new QGraphicsScene(this);
   m_view = new ProjectionView(m_scene);
   connect(m_view, &ProjectionView::doubleclicked, this, &VizProjection::selectProjection);
+  connect(m_view, &ProjectionView::viewportChanged, this, &VizProjection::updateViewport);
 
   m_view->setDragMode(QGraphicsView::RubberBandDrag);
   m_view->setRubberBandSelectionMode(Qt::ContainsItemShape);
@@ -303,6 +304,14 @@ void VizProjection::updateInnerDependences() {
   }
 }
 
+void VizProjection::updateViewport(const QRectF &visibleSceneRect) {
+  for (auto pile : m_coordinateSystems) {
+    for (VizCoordinateSystem *vcs : pile) {
+      vcs->updateViewport(visibleSceneRect);
+    }
+  }
+}
+
 void VizProjection::updateInternalDependences() {
   for (auto pile : m_coordinateSystems) {
     for (VizCoordinateSystem *vcs : pile) {
@@ -346,6 +355,8 @@ void VizProjection::projectScop(ClintScop *vscop) {
                           std::make_move_iterator(std::end(stmtOccurrences)));
   }
   std::sort(std::begin(allOccurrences), std::end(allOccurrences), VizStmtOccurrencePtrComparator());
+  vscop->prefetchPoints(m_horizontalDimensionIdx, m_verticalDimensionIdx,
+                        vizProperties()->clippingThreshold());
 
   VizCoordinateSystem *vcs              = nullptr;
   ClintStmtOccurrence *previousOccurrence = nullptr;
@@ -380,13 +391,13 @@ void VizProjection::projectScop(ClintScop *vscop) {
     vcs = m_coordinateSystems.back().back();
     visibleCS = vcs->projectStatementOccurrence(occurrence) || visibleCS;
     visiblePile = visiblePile || visibleCS;
+    std::pair<std::pair<int, int>, std::pair<int, int>> boundingBox =
+        occurrence->boundingBox(m_horizontalDimensionIdx, m_verticalDimensionIdx);
     if (m_horizontalDimensionIdx != VizProperties::NO_DIMENSION) {
-      horizontalMin = occurrence->minimumValue(m_horizontalDimensionIdx);
-      horizontalMax = occurrence->maximumValue(m_horizontalDimensionIdx);
+      std::tie(horizontalMin, horizontalMax) = boundingBox.first;
     }
     if (m_verticalDimensionIdx != VizProperties::NO_DIMENSION) {
-      verticalMin = occurrence->minimumValue(m_verticalDimensionIdx);
-      verticalMax = occurrence->maximumValue(m_verticalDimensionIdx);
+      std::tie(verticalMin, verticalMax) = boundingBox.second;
     }
     std::pair<int, int> minmax = columnMinMax.back();
     minmax.first  = std::min(minmax.first, horizontalMin);
@@ -425,6 +436,9 @@ void VizProjection::projectScop(ClintScop *vscop) {
   updateInnerDependences();
 
   updateSceneLayout();
+
+  // Clipped polyhedra were enumerated before their final position was known.
+  updateViewport(visibleSceneRect());
 }
 
 void VizProjection::updateColumnHorizontalMinMax(VizCoordinateSystem *coordinateSystem, int minOffset, int maxOffset) {
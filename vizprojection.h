@@ -119,12 +119,22 @@ public:
     return m_view && m_view->isActive();
   }
 
+  QRectF visibleSceneRect() const {
+    return m_view ? m_view->visibleSceneRect() : QRectF();
+  }
+
+  /// Zoom factor of the view, scene units to pixels.
+  double viewScale() const {
+    return m_view ? m_view->transform().m11() : 1.0;
+  }
+
 signals:
   void selected(int horizontal, int vertical);
 
 public slots:
   void updateProjection();
   void selectProjection();
+  void updateViewport(const QRectF &visibleSceneRect);
 
 private:
   ProjectionView *m_view;
@@ -30,6 +30,26 @@ void VizProperties::setCoordinateSystemMargin(double margin) {
   emit vizPropertyChanged();
 }
 
+void VizProperties::setClippingThreshold(int threshold) {
+  m_clippingThreshold = threshold;
+  emit vizPropertyChanged();
+}
+
+void VizProperties::setClippingMargin(double margin) {
+  m_clippingMargin = margin;
+  emit vizPropertyChanged();
+}
+
+void VizProperties::setPointBudget(int budget) {
+  m_pointBudget = budget;
+  emit vizPropertyChanged();
+}
+
+void VizProperties::setDensityCellSize(double size) {
+  m_densityCellSize = size;
+  emit vizPropertyChanged();
+}
+
 QDomElement VizProperties::toXML(QDomDocument &doc) const {
   QDomElement element = doc.createElement("vizproperties");
   element.setAttribute("polyhedronOffset", m_polyhedronOffset);
@@ -23,6 +23,22 @@ public:
   /*inline*/ double coordinateSystemMargin() const {
     return m_coordinateSystemMargin;
   }
+  /// Polyhedra with more points in their bounding box are only enumerated inside the viewport.
+  /*inline*/ int clippingThreshold() const {
+    return m_clippingThreshold;
+  }
+  /// Extra area enumerated around the viewport of a clipped polyhedron, relative to the viewport size.
+  /*inline*/ double clippingMargin() const {
+    return m_clippingMargin;
+  }
+  /// Polyhedra with more enumerated points are drawn as a density grid rather than point by point.
+  /*inline*/ int pointBudget() const {
+    return m_pointBudget;
+  }
+  /// Minimal on-screen size of a density grid cell, in pixels.
+  /*inline*/ double densityCellSize() const {
+    return m_densityCellSize;
+  }
 
   QColor color(const std::vector<int> &beta) const {
     int id = 0;
@@ -64,6 +80,22 @@ public:
              READ coordinateSystemMargin
              WRITE setCoordinateSystemMargin
              NOTIFY vizPropertyChanged)
+  Q_PROPERTY(int clippingThreshold
+             READ clippingThreshold
+             WRITE setClippingThreshold
+             NOTIFY vizPropertyChanged)
+  Q_PROPERTY(double clippingMargin
+             READ clippingMargin
+             WRITE setClippingMargin
+             NOTIFY vizPropertyChanged)
+  Q_PROPERTY(int pointBudget
+             READ pointBudget
+             WRITE setPointBudget
+             NOTIFY vizPropertyChanged)
+  Q_PROPERTY(double densityCellSize
+             READ densityCellSize
+             WRITE setDensityCellSize
+             NOTIFY vizPropertyChanged)
 
 signals:
   void vizPropertyChanged();
@@ -73,12 +105,20 @@ public slots:
   void setPointRadius(double radius);
   void setPointDistance(double distance);
   void setCoordinateSystemMargin(double margin);
+  void setClippingThreshold(int threshold);
+  void setClippingMargin(double margin);
+  void setPointBudget(int budget);
+  void setDensityCellSize(double size);
 
 private:
   double m_polyhedronOffset       = 4.0;
   double m_pointRadius            = 4.0;
   double m_pointDistance          = 16.0;
   double m_coordinateSystemMargin = 5.0;
+  int    m_clippingThreshold      = 20000;
+  double m_clippingMargin         = 0.5;
+  int    m_pointBudget            = 20000;
+  double m_densityCellSize        = 4.0;
 
   bool m_filledPolygons           = true;
   bool m_filledPoints             = false;